@@ -1,9 +1,15 @@
+#include <algorithm>
 #include <cstring>
+#include <new>
 #include <string>
 #include <functional>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <iostream>
 #include <array>
@@ -46,24 +52,48 @@ double safe_stod(const char* s)
     return ret;
 }
 
-std::string sanitize(const std::string& s)
+// Interpreterが生成時に1度だけTcl_Objを作って保持し、以降のcall()で使い回す語の一覧。
+// ウィジェットメソッドが毎回組み立てる定型のサブコマンド名・オプション名に限る(任意の
+// ユーザー文字列まで溜め込むと無制限に増えてしまうため、ここに列挙した語だけを対象にする)。
+// 同じTcl_Objを使い回すと、Tcl_GetIndexFromObj等によるサブコマンド/オプション解決の結果が
+// そのオブジェクト自身にキャッシュされ、2回目以降の解決が文字列比較なしで済む。
+const char* const interned_words[] = {
+    // コマンド・サブコマンド
+    "configure", "cget", "coords", "move", "moveto", "insert", "delete", "get", "set",
+    "index", "see", "xview", "yview", "bbox", "itemconfigure", "itemcget", "raise", "lower",
+    "tag", "find", "create", "line", "rectangle", "oval", "polygon", "text", "image", "window",
+    "pack", "grid", "place", "forget", "winfo", "width", "height", "reqwidth", "reqheight",
+    "x", "y", "rootx", "rooty", "exists", "children", "bind", "after", "idle", "cancel",
+    "update", "idletasks", "destroy", "event", "generate", "focus", "wm", "title", "geometry",
+    "state", "selection", "item", "heading", "column", "parent", "identify",
+    "invoke", "add", "entryconfigure", "current", "end", "apply",
+    // オプション
+    "-text", "-textvariable", "-variable", "-value", "-values", "-command", "-image",
+    "-width", "-height", "-fill", "-expand", "-side", "-anchor", "-padx", "-pady", "-ipadx",
+    "-ipady", "-row", "-column", "-rowspan", "-columnspan", "-sticky", "-in", "-x", "-y",
+    "-relx", "-rely", "-relwidth", "-relheight", "-bg", "-fg", "-background", "-foreground",
+    "-font", "-state", "-relief", "-borderwidth", "-bd", "-outline", "-tags", "-orient",
+    "-from", "-to", "-length", "-justify", "-wrap", "-cursor", "-takefocus", "-style",
+    "-selectmode", "-show", "-label", "-menu", "-underline",
+};
+
+// 数値配列を1つのTclリストにする。要素objを先に並べてからTcl_NewListObj()を1回だけ呼ぶため、
+// 要素ごとのTcl_ListObjAppendElement()によるリスト内部配列の再確保が起きない。
+template <typename T, typename NewElem>
+Tcl_Obj* make_number_list(const T* data, std::size_t size, NewElem new_elem)
 {
-    std::string ret;
-    for (char c : s)
+    const std::size_t stack_capacity = 64;
+    Tcl_Obj* stack_objv[stack_capacity];
+    std::vector<Tcl_Obj*> heap_objv;
+    Tcl_Obj** objv = stack_objv;
+    if (size > stack_capacity)
     {
-        ret += std::isalnum(c) ? c : '_';
+        heap_objv.resize(size);
+        objv = heap_objv.data();
     }
-    return ret;
-}
-
-// Menuの各項目("-command")用の一意なTclプロシージャ名を生成する。項目はindexでしか
-// 識別できず、indexは挿入/削除で変動するため、Menuインスタンス単位ではなくプロセス全体で
-// 単調増加するカウンタを使って衝突を避ける(以前設定した項目のindexが後から他の項目に
-// ずれても、既存の"-command"が指す名前付きプロシージャ自体は変わらないため実害は無い)。
-std::string next_menu_entry_callback_name(const std::string& menu_full_name)
-{
-    static int counter = 0;
-    return sanitize(menu_full_name) + "_menu_entry_cb_" + std::to_string(counter++);
+    for (std::size_t i = 0; i < size; ++i)
+        objv[i] = new_elem(data[i]);
+    return Tcl_NewListObj((int)size, objv);
 }
 
 // ArgValue を対応する Tcl_Obj* に変換する内部ヘルパー
@@ -92,6 +122,17 @@ Tcl_Obj* make_obj(Tcl_Interp* interp, const cpp_tk::ArgValue& v)
             }
             return list_obj;
         }
+        case cpp_tk::ArgValue::ValueType::STRING_REF:
+            return Tcl_NewStringObj(v.as_string_ref().data, (int)v.as_string_ref().size);
+        case cpp_tk::ArgValue::ValueType::INT_ARRAY:
+            return make_number_list(v.as_int_array().data, v.as_int_array().size,
+                                    [](int x) { return Tcl_NewIntObj(x); });
+        case cpp_tk::ArgValue::ValueType::DOUBLE_ARRAY:
+            return make_number_list(v.as_double_array().data, v.as_double_array().size,
+                                    [](double x) { return Tcl_NewDoubleObj(x); });
+        case cpp_tk::ArgValue::ValueType::OBJ:
+            // 構築済みの値はそのまま共有する(呼び出し側が参照カウントを増減するため、ここでは増やさない)。
+            return v.as_obj();
         case cpp_tk::ArgValue::ValueType::DICT:
         {
             Tcl_Obj* dict_obj = Tcl_NewDictObj();
@@ -112,108 +153,619 @@ Tcl_Obj* make_obj(Tcl_Interp* interp, const cpp_tk::ArgValue& v)
 namespace cpp_tk
 {
 
-std::unordered_map<std::thread::id, Interpreter*> interp_map;
+// 呼び出しスレッドのInterpreter(current_interp()参照)。Interpreterはスレッドごとに1つなので、
+// 生成済みなら取得は単なるTLSの読み出しで済む。
+static thread_local Interpreter* t_interp = nullptr;
+
+// 全スレッドのInterpreterの登録簿。スレッド横断の参照(interpreter_threads())専用で、生成時と
+// スレッドの終了時(InterpreterThreadExit)に書き込む。各スレッドが自分のInterpreterを引く経路(t_interp)は
+// このロックを取らない。
+static std::mutex g_interp_registry_mutex;
+static std::unordered_map<std::thread::id, Interpreter*> g_interp_registry;
+
+// 全スレッド共通の設定のため、各GUIスレッドから同期なしで読み書きできるようatomicにする。
+static std::atomic<ErrorPolicy> g_error_policy{ErrorPolicy::DEFAULT};
 
-static ErrorPolicy g_error_policy = ErrorPolicy::DEFAULT;
+// tk::stats()用の計数(全スレッドの合計)。
+static std::atomic<std::size_t> g_callbacks_created{0};
+static std::atomic<std::size_t> g_callbacks_released{0};
+static std::atomic<std::size_t> g_callback_owners{0};
 
 void set_error_policy(ErrorPolicy policy)
 {
-    g_error_policy = policy;
+    g_error_policy.store(policy, std::memory_order_relaxed);
 }
 
 ErrorPolicy error_policy()
 {
-    return g_error_policy;
+    return g_error_policy.load(std::memory_order_relaxed);
+}
+
+// set_error_handler()/set_callback_exception_handler()で差し替えられる全スレッド共通のハンドラ。
+// 差し替えと他スレッドでの呼び出しが競合しないよう、呼び出し側はget()で共有ポインタを取り出し、
+// ロックを離してから呼ぶ(呼び出し中に差し替えられても、取り出したハンドラは呼び終わるまで生きている)。
+template <typename Fn>
+class SharedHandler
+{
+
+public:
+
+    explicit SharedHandler(Fn fn = nullptr)
+    {
+        set(std::move(fn));
+    }
+
+    void set(Fn fn)
+    {
+        std::shared_ptr<const Fn> next = fn ? std::make_shared<const Fn>(std::move(fn)) : nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_.swap(next);
+    }
+
+    std::shared_ptr<const Fn> get() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return fn_;
+    }
+
+private:
+
+    mutable std::mutex        mutex_;
+    std::shared_ptr<const Fn> fn_;
+
+};
+
+std::string ErrorRecord::what() const
+{
+    const std::string op = std::string(operation ? operation : "") + "()";
+    const std::string type = object_type ? object_type : "object";
+    switch (kind)
+    {
+        case Kind::TCL_FAILURE:
+            return op + " failed to execute Tcl command";
+        case Kind::UNINITIALIZED:
+            return op + " called on an uninitialized " + type + " (interp == nullptr).";
+        case Kind::WRONG_THREAD:
+            return op + " called on a " + type + " from a thread different than the one that owns its Tcl interpreter. "
+                "Tcl_Interp must only be accessed from the thread that created it.";
+        case Kind::THREAD_EXITED:
+            return op + " called on a " + type + " whose Tcl interpreter was destroyed when its thread exited.";
+        case Kind::UNEXPECTED_ARGUMENTS:
+            return op + " got arguments for a " + type + " without params.";
+    }
+    return op + " failed";
+}
+
+std::string ErrorRecord::command() const
+{
+    std::string text;
+    for (const auto& word : command_words)
+    {
+        if (!text.empty())
+            text += ' ';
+        text += word;
+    }
+    return text;
+}
+
+std::string ErrorRecord::message() const
+{
+    std::string result = what();
+    if (!detail.empty())
+        result += ": " + detail;
+    if (!command_words.empty())
+        result += " (command: " + command() + ")";
+    if (suppressed > 0)
+        result += " [" + std::to_string(suppressed) + " similar errors suppressed]";
+    return result;
+}
+
+// drain_errors()用の全スレッド共通のリングバッファ。各スロットのシーケンス番号で書き込み/読み出しの
+// 順番を決める有界MPMCキュー(Dmitry Vyukov方式)で、ロックを取らない。満杯ならpush()は最も古い記録を
+// 取り除いてから書き込む(エラーが続く間も、drain_errors()で直近の記録が読めるように)。
+class ErrorRing
+{
+
+public:
+
+    ErrorRing()
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    void push(ErrorRecord&& record)
+    {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots_[pos % capacity];
+            std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.record = std::move(record);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (diff < 0)
+            {
+                ErrorRecord oldest;
+                pop(oldest);
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(ErrorRecord& record)
+    {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots_[pos % capacity];
+            std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    record = std::move(slot.record);
+                    slot.sequence.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+
+    static constexpr std::size_t capacity = 256;
+
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        ErrorRecord              record;
+    };
+
+    Slot                     slots_[capacity];
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<std::size_t> head_{0};
+
+};
+
+static ErrorRing& error_ring()
+{
+    static ErrorRing ring;
+    return ring;
+}
+
+static SharedHandler<std::function<void(const ErrorRecord&)>> g_error_handler;
+
+static std::atomic<long long> g_error_rate_limit_ms{1000};
+
+void set_error_handler(std::function<void(const ErrorRecord&)> handler)
+{
+    g_error_handler.set(std::move(handler));
+}
+
+void set_error_rate_limit(std::chrono::milliseconds interval)
+{
+    g_error_rate_limit_ms.store(interval.count(), std::memory_order_relaxed);
+}
+
+std::vector<ErrorRecord> drain_errors()
+{
+    std::vector<ErrorRecord> records;
+    ErrorRecord record;
+    while (error_ring().pop(record))
+        records.push_back(std::move(record));
+    return records;
 }
 
-// checked_interp()/call()共通の失敗時挙動。ログ出力は常に行い、successが渡されていれば
-// (呼び出し元でok判定する前提なので)例外は投げない。successがnullptrなら、categoryに対応する
-// ビットがerror_policy()に含まれているかで判定する(含まれていなければStrict扱いでErrorを送出)。
-static void report_or_throw(const std::string& message, bool* success, ErrorPolicy category)
+// 呼び出し箇所のキー(FNV-1a)。同じ失敗が繰り返される場合に文字列を組み立てずに同一性を判定するため。
+static std::uint64_t hash_bytes(std::uint64_t h, const char* data, std::size_t size)
 {
-    std::cerr << "cpp_tk Error: " << message << std::endl;
-    if (success)
+    for (std::size_t i = 0; i < size; ++i)
     {
-        *success = false;
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static const std::uint64_t error_site_seed = 14695981039346656037ull;
+
+// keyの呼び出し箇所を今回通知すべきかを判定する。間引く場合は件数を数えるだけでfalseを返す。
+// 状態は報告スレッドごとに持つためロックは要らない。表はkeyの下位ビットで選んだ組ごとに4つの枠を持ち
+// (4ウェイのセットアソシアティブ)、同じ組に落ちた箇所が交互に失敗しても互いを追い出さない。組に空きが
+// なければ最も古い枠(間隔を過ぎた枠があればその中のどれか)を再利用する。
+static bool should_report(std::uint64_t key, std::size_t* suppressed)
+{
+    struct Site
+    {
+        std::uint64_t                         key = 0;
+        bool                                  used = false;
+        std::chrono::steady_clock::time_point last;
+        std::size_t                           suppressed = 0;
+    };
+    enum { SETS = 64, WAYS = 4 };
+    static thread_local Site sites[SETS][WAYS];
+
+    *suppressed = 0;
+    const long long interval_ms = g_error_rate_limit_ms.load(std::memory_order_relaxed);
+    if (interval_ms <= 0)
+        return true;
+
+    const auto now      = std::chrono::steady_clock::now();
+    const auto interval = std::chrono::milliseconds(interval_ms);
+    Site* set    = sites[key % SETS];
+    Site* victim = nullptr;
+    for (int way = 0; way < WAYS; ++way)
+    {
+        Site& site = set[way];
+        if (site.used && site.key == key)
+        {
+            if (now - site.last < interval)
+            {
+                ++site.suppressed;
+                return false;
+            }
+            *suppressed     = site.suppressed;
+            site.last       = now;
+            site.suppressed = 0;
+            return true;
+        }
+        if (!site.used)
+        {
+            if (!victim || victim->used)
+                victim = &site;
+        }
+        else if (!victim || (victim->used && site.last < victim->last))
+            victim = &site;
+    }
+
+    victim->key        = key;
+    victim->used       = true;
+    victim->last       = now;
+    victim->suppressed = 0;
+    return true;
+}
+
+// レート制限を通過した記録をハンドラ(既定はstderr)へ渡し、drain_errors()用に溜める。
+static void dispatch_error(ErrorRecord&& record)
+{
+    if (auto handler = g_error_handler.get())
+        (*handler)(record);
+    else
+        std::cerr << "cpp_tk Error: " << record.message() << '\n';
+    error_ring().push(std::move(record));
+}
+
+// checked_interp()/call()共通の失敗時挙動。通知(set_error_handler()、既定はstderr)はレート制限の範囲で
+// 常に行い、successが渡されていれば(呼び出し元でok判定する前提なので)例外は投げない。successがnullptrなら、
+// categoryに対応するビットがerror_policy()に含まれているかで判定する(含まれていなければStrict扱いでErrorを送出)。
+// 呼び出し箇所はoperationとcategory・kindで判定する。記録には構成要素(operation/object_typeは静的な文字列)
+// だけを持たせ、メッセージは読まれる時か、Errorを送出する時にだけ組み立てる。
+static void report_or_throw(const char* operation, bool* success, ErrorPolicy category, ErrorRecord::Kind kind, const char* object_type)
+{
+    const unsigned site = static_cast<unsigned>(category) | (static_cast<unsigned>(kind) << 8);
+    std::uint64_t key = hash_bytes(error_site_seed ^ site, operation, std::strlen(operation));
+    const bool strict = !success && !has_error_policy(error_policy(), category);
+    std::size_t suppressed = 0;
+    const bool report = should_report(key, &suppressed);
+    if (!report && !strict)
+    {
+        if (success) *success = false;
+        return;
+    }
+
+    ErrorRecord record{category, kind, operation, object_type, std::string(), {}, suppressed, std::this_thread::get_id()};
+    if (!strict)
+    {
+        dispatch_error(std::move(record));
+        if (success) *success = false;
         return;
     }
-    if (!has_error_policy(error_policy(), category))
-        throw Error(message);
+    std::string message = record.what();
+    if (report)
+        dispatch_error(std::move(record));
+    throw Error(message);
 }
 
-static std::function<void(const std::exception&)> g_callback_exception_handler =
+class Interpreter;
+
+// Tcl呼び出しの失敗("<operation>() failed to execute Tcl command")をreport_or_throw()と同じ規則で報告する
+// (Interpreterの定義の後で定義する)。
+static void report_tcl_failure(const Interpreter& p, const char* operation, bool* success);
+
+static SharedHandler<std::function<void(const std::exception&)>> g_callback_exception_handler(
     [](const std::exception& e) {
         std::cerr << "cpp_tk Error: uncaught exception in callback: " << e.what() << std::endl;
-    };
+    });
 
 void set_callback_exception_handler(std::function<void(const std::exception&)> handler)
 {
-    g_callback_exception_handler = std::move(handler);
+    g_callback_exception_handler.set(std::move(handler));
 }
 
+// 別スレッドで生成されるInterpreterからも読まれるため、g_interp_init_mutexで保護する。
 static std::string g_tcl_library_override;
 static std::string g_tk_library_override;
 
+// Interpreterの初期化(Tcl_Init/Tk_Init)を直列化する。複数のGUIスレッドが同時に最初のInterpreterを
+// 生成しても、ランタイムスクリプトの探索・読み込みが並行して走らないようにする(1スレッドにつき1回だけ通る)。
+static std::mutex g_interp_init_mutex;
+
 void set_runtime_library_paths(const std::string& tcl_library, const std::string& tk_library)
 {
+    std::lock_guard<std::mutex> lock(g_interp_init_mutex);
     g_tcl_library_override = tcl_library;
     g_tk_library_override  = tk_library;
 }
 
+// 呼び出しスレッドで実行中のコールバックの入れ子の深さ(reset_interpreter()の呼び出し可否の判定用)。
+// Tcl_SetVar等のC APIから起動された変数トレースはTcl_InterpActive()に現れないため、自前で数える。
+static thread_local int t_callback_depth = 0;
+
+// set_callback_profiling()で切り替える全スレッド共通のフラグ。無効時のinvoke_guarded()の追加コストは
+// このフラグの読み出し1回だけ。
+static std::atomic<bool> g_callback_profiling{false};
+
+// 計測結果はコールバックを実行したスレッドごとに溜める(callback_stats()は呼び出しスレッドの分を返す)。
+// キーはprofile_key(コールバックのコマンド名等)。
+static thread_local std::unordered_map<std::string, CallbackStats> t_callback_profile;
+
+// post()のjobの通し番号(計測結果のキー"post <N>"用)。post()はどのスレッドからも呼ばれるためatomicにする。
+static std::atomic<unsigned long> g_post_serial{0};
+
+// CallbackStats::histogramの各区間の上限(マイクロ秒)。最後の区間は上限なし。
+static const long long callback_histogram_bounds_us[] = {100, 500, 1000, 2000, 4000, 8000, 16000};
+
+// profile_keyのコールバックを見分けるための説明("<ウィジェットのパス> <役割>"等)を返す
+// (Interpreterの定義の後で定義する)。
+static std::string describe_callback(const std::string& profile_key);
+
+// invoke_guarded()の1回分の所要時間を計り、スコープを抜ける時にprofile_keyの記録へ足し込む。
+class CallbackTimer
+{
+
+public:
+
+    CallbackTimer(const char* profile_key, const char* description)
+        : key_(profile_key && g_callback_profiling.load(std::memory_order_relaxed) ? profile_key : nullptr)
+        , description_(description)
+    {
+        if (key_)
+            start_ = std::chrono::steady_clock::now();
+    }
+
+    ~CallbackTimer()
+    {
+        if (!key_)
+            return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        auto found = t_callback_profile.find(key_);
+        if (found == t_callback_profile.end())
+        {
+            CallbackStats entry = CallbackStats();
+            entry.name        = key_;
+            entry.description = description_ ? std::string(description_) : describe_callback(entry.name);
+            found = t_callback_profile.emplace(entry.name, std::move(entry)).first;
+        }
+        CallbackStats& entry = found->second;
+        ++entry.calls;
+        entry.total_time += elapsed;
+        if (elapsed > entry.max_time)
+            entry.max_time = elapsed;
+        const long long us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        std::size_t bucket = 0;
+        while (bucket < entry.histogram.size() - 1 && us >= callback_histogram_bounds_us[bucket])
+            ++bucket;
+        ++entry.histogram[bucket];
+    }
+
+    CallbackTimer(const CallbackTimer&) = delete;
+    CallbackTimer& operator=(const CallbackTimer&) = delete;
+
+private:
+
+    const char*                           key_;
+    const char*                           description_;
+    std::chrono::steady_clock::time_point start_;
+
+};
+
+// 解放されたコールバックの記録(profile_key)を、aggregate_keyの記録に合算して取り除く。コールバックごとの
+// キー(トークン等)は作っては捨てられるため、解放後も個別に残すと記録が際限なく増える。
+static void fold_callback_stats(const std::string& profile_key, const char* aggregate_key)
+{
+    auto found = t_callback_profile.find(profile_key);
+    if (found == t_callback_profile.end())
+        return;
+    CallbackStats released = std::move(found->second);
+    t_callback_profile.erase(found);
+
+    CallbackStats& entry = t_callback_profile[aggregate_key];
+    if (entry.name.empty())
+    {
+        entry.name        = aggregate_key;
+        entry.description = "released callbacks";
+    }
+    entry.calls      += released.calls;
+    entry.total_time += released.total_time;
+    if (released.max_time > entry.max_time)
+        entry.max_time = released.max_time;
+    for (std::size_t i = 0; i < entry.histogram.size(); ++i)
+        entry.histogram[i] += released.histogram[i];
+}
+
 // register_*_callback/trace_varのトランポリン(TclのCコールスタックから直接呼ばれる)専用。
 // コールバック本体は必ずこれ経由で呼び出し、C++例外がTcl側のCフレームへ伝播しないようにする。
 // ハンドラ自体が例外を投げても、ここで握りつぶしてTcl側には一切伝播させない。
-static void invoke_guarded(const std::function<void()>& body)
+// profile_keyを渡すと、set_callback_profiling(true)の間だけ呼び出し回数・所要時間を記録する。
+// descriptionは記録の説明(省略時はdescribe_callback()で登録先を引く)。
+static void invoke_guarded(const std::function<void()>& body, const char* profile_key = nullptr, const char* description = nullptr)
 {
+    struct DepthGuard
+    {
+        DepthGuard()  { ++t_callback_depth; }
+        ~DepthGuard() { --t_callback_depth; }
+    } depth_guard;
+
+    CallbackTimer timer(profile_key, description);
+
     try
     {
         body();
     }
     catch (const std::exception& e)
     {
-        try { g_callback_exception_handler(e); } catch (...) {}
+        auto handler = g_callback_exception_handler.get();
+        try { if (handler) (*handler)(e); } catch (...) {}
     }
     catch (...)
     {
-        try { g_callback_exception_handler(std::runtime_error("unknown exception in cpp_tk callback")); } catch (...) {}
+        auto handler = g_callback_exception_handler.get();
+        try { if (handler) (*handler)(std::runtime_error("unknown exception in cpp_tk callback")); } catch (...) {}
     }
 }
 
+// Widget::exec_direct()用に、ウィジェットコマンドを解決した結果を保持する(Widget::Implが所有する)。
+// validはコマンドの削除/renameトレースでfalseに戻される(Interpreter::resolve_command()参照)。
+struct WidgetCommandCache
+{
+    Tcl_CmdInfo info;
+    bool        valid = false;
+};
+
+// Timerの予約1つ分。Timerのハンドルと、Interpreterの一覧(timers_)が共有する。Tclのタイマハンドラの
+// ClientDataには生ポインタを渡し、一覧に載っている間(=予約が有効な間)は生存が保証される。
+struct TimerState
+{
+    Interpreter*                          interp   = nullptr;
+    Tcl_TimerToken                        token    = nullptr;
+    std::function<void()>                 callback;
+    std::chrono::milliseconds             interval{0};
+    std::chrono::steady_clock::time_point due;
+    bool                                  periodic = false;
+    bool                                  active   = false;
+    int                                   running  = 0;
+    unsigned                              serial   = 0;  // 計測結果のキー("timer <serial>")
+};
+
 class Interpreter
 {
 
 public:
 
-    Interpreter()
+    // with_tkがfalseならTk_Initを行わない(create_tcl_only_interpreter()参照)。Tkは後から
+    // ensure_tk()で読み込める。
+    explicit Interpreter(bool with_tk = true)
         : interp_(nullptr)
+        , has_tk_(false)
         , owner_thread_(std::this_thread::get_id())
         , owner_tcl_thread_(Tcl_GetCurrentThread())
     {
-        interp_ = Tcl_CreateInterp();
-        if (!g_tcl_library_override.empty())
-            Tcl_SetVar(interp_, "tcl_library", g_tcl_library_override.c_str(), TCL_GLOBAL_ONLY);
-        if (Tcl_Init(interp_) != TCL_OK)
+        std::lock_guard<std::mutex> lock(g_interp_init_mutex);
+        create_interp(with_tk);
+        intern_words();
+    }
+
+    ~Interpreter()
+    {
+        release_state();
+        for (auto& kv : interned_words_)
+            Tcl_DecrRefCount(kv.second);
+        interned_words_.clear();
+        Tcl_DeleteInterp(interp_);
+        interp_ = nullptr;
+    }
+
+    // tk::reset_interpreter()の実処理。Tcl_Interpを破棄して作り直す(Tclのみか否かは引き継ぐ)。
+    // このInterpreter自体は作り直さないため、Widget/Var等が保持するポインタはそのまま有効で、
+    // 古いウィジェットやVarの名前は新しいTcl_Interpに存在しないものとして通常のTclエラーになる。
+    // ウィジェットコマンドのキャッシュ(WidgetCommandCache)は、Tcl_DeleteInterpがコマンドを削除する際の
+    // 削除トレースで無効化される。
+    void reset()
+    {
+        if (t_callback_depth > 0 || Tcl_InterpActive(interp_))
+            throw Error("reset_interpreter() cannot be called while the interpreter is evaluating a command");
+
+        release_state();
+        Tcl_DeleteEvents(&Interpreter::discard_posted_job, nullptr);
+        for (auto& kv : interned_words_)
+            Tcl_DecrRefCount(kv.second);
+        interned_words_.clear();
+
+        const bool with_tk = has_tk_;
+        Tcl_DeleteInterp(interp_);
+        interp_ = nullptr;
+        has_tk_ = false;
+
+        std::lock_guard<std::mutex> lock(g_interp_init_mutex);
+        try
         {
-            std::string message = "Tcl_Init failed: " + std::string(Tcl_GetStringResult(interp_));
-            Tcl_DeleteInterp(interp_);
-            interp_ = nullptr;
-            throw Error(message);
+            create_interp(with_tk);
         }
-        if (!g_tk_library_override.empty())
-            Tcl_SetVar(interp_, "tk_library", g_tk_library_override.c_str(), TCL_GLOBAL_ONLY);
-        if (Tk_Init(interp_) != TCL_OK)
+        catch (const Error&)
         {
-            std::string message = "Tk_Init failed: " + std::string(Tcl_GetStringResult(interp_));
-            Tcl_DeleteInterp(interp_);
-            interp_ = nullptr;
-            throw Error(message);
+            // Tk_Initに失敗しても、Tclのみのインタプリタとしては使える状態に戻しておく。
+            if (!interp_ && with_tk)
+                create_interp(false);
+            intern_words();
+            throw;
         }
+        intern_words();
     }
 
-    ~Interpreter()
+    // スレッドの終了時(InterpreterThreadExit参照)の後始末。Tcl_Interpとそれに結び付く状態を破棄する。
+    // 他スレッドに残ったWidget/Var等のハンドルがこのオブジェクトを指し続けるため、オブジェクト自体は
+    // 解放しない。以後はalive()がfalseになり、checked_interp()・post()・release_widget_objects()は
+    // Tclに触れずに失敗する(所有スレッドのIDが後のスレッドに再利用されても同じ)。
+    void retire()
     {
+        {
+            std::lock_guard<std::mutex> lock(post_mutex_);
+            alive_.store(false, std::memory_order_release);
+        }
+        release_state();
+        Tcl_DeleteEvents(&Interpreter::discard_posted_job, nullptr);
+        for (auto& kv : interned_words_)
+            Tcl_DecrRefCount(kv.second);
+        interned_words_.clear();
         Tcl_DeleteInterp(interp_);
         interp_ = nullptr;
+        has_tk_ = false;
+    }
+
+    bool alive() const { return alive_.load(std::memory_order_acquire); }
+
+    bool has_tk() const { return has_tk_; }
+
+    // Tclのみで生成したInterpreterに、後からTkを読み込む(tk::Tkの構築時に呼ばれる)。
+    // 読み込み済みなら何もしない。失敗してもInterpreter自体はTclのみのまま使い続けられる。
+    void ensure_tk()
+    {
+        if (has_tk_)
+            return;
+        std::lock_guard<std::mutex> lock(g_interp_init_mutex);
+        if (!init_tk())
+            throw Error("Tk_Init failed: " + std::string(Tcl_GetStringResult(interp_)));
     }
 
     // Tcl_Interpは生成したスレッド以外から触ってはいけない(スレッド間で共有するAPIではない)。
@@ -223,518 +775,2548 @@ public:
 
     // Tcl_ThreadQueueEventで対象スレッドのTclイベントループへjobを安全に注入する(post()相当の実処理)。
     // このメソッド自体はどのスレッドから呼んでも安全(Tcl_ThreadQueueEvent/Tcl_ThreadAlertはスレッド
-    // セーフなAPIとしてTcl自身が提供している)。
-    void post(std::function<void()> job)
+    // セーフなAPIとしてTcl自身が提供している)。所有スレッドが終了済み(retire())なら、jobを実行せずに
+    // 破棄してfalseを返す。判定と注入はretire()と同じロックの中で行い、終了と入れ違いにならないようにする。
+    bool post(std::function<void()> job)
     {
+        std::unique_lock<std::mutex> lock(post_mutex_);
+        if (!alive_.load(std::memory_order_relaxed))
+        {
+            lock.unlock();
+            job = nullptr;
+            return false;
+        }
         auto* evPtr = reinterpret_cast<PostedJobEvent*>(Tcl_Alloc(sizeof(PostedJobEvent)));
         evPtr->header.proc     = &Interpreter::handle_posted_job;
         evPtr->header.nextPtr  = nullptr;
         evPtr->job             = new std::function<void()>(std::move(job));
+        evPtr->serial          = g_post_serial.fetch_add(1, std::memory_order_relaxed) + 1;
         Tcl_ThreadQueueEvent(owner_tcl_thread_, reinterpret_cast<Tcl_Event*>(evPtr), TCL_QUEUE_TAIL);
         Tcl_ThreadAlert(owner_tcl_thread_);
+        return true;
     }
 
-    std::string call(const std::vector<ArgValue>& words, bool* success = nullptr)
+    // pathには呼び出し元ウィジェットのキャッシュ済みパス名(InterpreterClient::path_obj())を渡す。
+    // wordsのうちpathと同じ文字列の語、およびinterned_wordsに列挙した定型語は、Tcl_Objを
+    // 新規生成せず既存のものを使い回す(word_obj()参照)。
+    std::string call(const std::vector<ArgValue>& words, bool* success = nullptr, Tcl_Obj* path = nullptr)
     {
-        std::vector<Tcl_Obj*> objv;
-        objv.reserve(words.size());
-        for (const auto& w : words)
-            objv.push_back(make_obj(interp_, w));
+        bool ok = eval(words, path);
+        if (success)
+            *success = ok;
+        return result_string();
+    }
 
-        for (auto* obj : objv)
-            Tcl_IncrRefCount(obj);
+    // call()の実処理。結果は文字列化せずTcl_GetObjResult()に残したまま、成否だけを返す
+    // (結果の読み取り方は呼び出し側がcall()/result_int()等で選ぶ)。
+    bool eval(const std::vector<ArgValue>& words, Tcl_Obj* path = nullptr)
+    {
+        // バッチ中に結果を必要とする呼び出しが来たら、それより前に溜めたコマンドを先に実行して
+        // 呼び出し順を保つ(例: config()直後のcget()が古い値を読まないように)。
+        flush_pending();
 
-        int code = Tcl_EvalObjv(interp_, (int)objv.size(), objv.data(), 0);
+        WordObjs objv(*this, words, path);
+        return eval_objv(objv.objc(), objv.objv());
+    }
 
-        bool ok = (code == TCL_OK);
-        if (!ok)
-        {
-            std::cerr << "Tcl Error: " << Tcl_GetStringResult(interp_) << " (command:";
-            for (auto* obj : objv)
-                std::cerr << " " << Tcl_GetString(obj);
-            std::cerr << ")" << std::endl;
-        }
+    // tk::Script用。同じscriptのTcl_Objを渡し続ける限り、Tcl_EvalObjEx()が初回にコンパイルした
+    // バイトコードがその内部表現に残り、2回目以降はコンパイルを省ける。常にグローバルレベルで評価する。
+    bool eval_script(Tcl_Obj* script)
+    {
+        flush_pending();
 
-        for (auto* obj : objv)
-            Tcl_DecrRefCount(obj);
+        int code = Tcl_EvalObjEx(interp_, script, TCL_EVAL_GLOBAL);
 
-        if (success)
-            *success = ok;
-        return Tcl_GetStringResult(interp_);
+        bool ok = (code == TCL_OK);
+        if (!ok)
+            remember_failed_command(1, &script);
+        return ok;
     }
 
-    // Tclのリスト形式の文字列(要素にスペースを含む場合は{}や""で囲まれる)を、
-    // 単純な空白split(既存のwinfo_children等が使っている方式)では壊れてしまうため、
-    // Tcl_SplitListで正しく要素分解する。
-    std::vector<std::string> split_list(const std::string& list) const
+    // 結果を使わない呼び出し(InterpreterClient::exec())用。バッチ中(begin_batch()〜end_batch())は
+    // その場で評価せず語をTcl_Objに変換して溜めておき、成功扱いでtrueを返す(実際の成否は
+    // flush_batch()で1件ずつ報告される)。バッチ外ではeval()と同じ。
+    bool exec(const std::vector<ArgValue>& words, Tcl_Obj* path = nullptr)
     {
-        int argc = 0;
-        const char** argv = nullptr;
-        std::vector<std::string> result;
-        if (Tcl_SplitList(interp_, list.c_str(), &argc, &argv) == TCL_OK)
+        if (batch_depth_ == 0)
+            return eval(words, path);
+
+        for (const auto& w : words)
         {
-            result.reserve(argc);
-            for (int i = 0; i < argc; ++i)
-                result.emplace_back(argv[i]);
-            Tcl_Free(reinterpret_cast<char*>(argv));
+            Tcl_Obj* obj = word_obj(w, path);
+            Tcl_IncrRefCount(obj);
+            batch_objv_.push_back(obj);
         }
-        return result;
+        batch_command_sizes_.push_back(words.size());
+        return true;
     }
 
-    void set_var(const std::string& name, const std::string& value)
-    {
-        Tcl_SetVar(interp_, name.c_str(), value.c_str(), TCL_GLOBAL_ONLY);
-    }
-    
-    std::string get_var(const std::string& name)
+    // tk::Batchの入れ子に対応するため深さで管理し、最も外側のend_batch()でのみflushする。
+    void begin_batch()
     {
-        const char* val = Tcl_GetVar(interp_, name.c_str(), TCL_GLOBAL_ONLY);
-        return val ? val : "";
+        ++batch_depth_;
     }
 
-    void trace_var(const std::string& name, std::function<void(const std::string&)> callback)
+    void end_batch(bool* success)
     {
-        string_callback_map_[name] = callback;
-        Tcl_TraceVar(interp_, name.c_str(), TCL_TRACE_WRITES, [](ClientData client_data, Tcl_Interp* interp, const char* name1, const char* name2, int flags) -> char* {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->string_callback_map_.find(name1);
-            if (it != self->string_callback_map_.end()) {
-                const char* val = Tcl_GetVar(interp, name1, TCL_GLOBAL_ONLY);
-                std::string v = val ? val : "";
-                invoke_guarded([&]() { it->second(v); });
-            }
-            return nullptr;
-        }, this);
+        if (batch_depth_ > 0 && --batch_depth_ == 0)
+            flush_batch(success);
     }
 
-    void trace_var(const std::string& name, std::function<void(const int&)> callback)
+    // 溜めたコマンドを順に評価する。失敗したコマンドは1件ずつreport_or_throw()に通すため、
+    // successがnullptrでerror_policy()がErrorの送出を求める場合は最初の失敗で送出し、
+    // 残りのコマンドは破棄する(バッチを使わずに順に呼んだ場合に、例外で以降の呼び出しに
+    // 到達しないのと同じ結果になる)。評価中のコールバックが新たにexec()した分は次回に回す。
+    void flush_batch(bool* success)
     {
-        int_callback_map_[name] = callback;
-        Tcl_TraceVar(interp_, name.c_str(), TCL_TRACE_WRITES, [](ClientData client_data, Tcl_Interp* interp, const char* name1, const char* name2, int flags) -> char* {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->int_callback_map_.find(name1);
-            if (it != self->int_callback_map_.end()) {
-                const char* val = Tcl_GetVar(interp, name1, TCL_GLOBAL_ONLY);
-                int v = val ? std::stol(val) : 0;
-                invoke_guarded([&]() { it->second(v); });
-            }
-            return nullptr;
-        }, this);
-    }
+        if (success)
+            *success = true;
+        if (batch_objv_.empty())
+            return;
 
-    void trace_var(const std::string& name, std::function<void(const double&)> callback)
-    {
-        double_callback_map_[name] = callback;
-        Tcl_TraceVar(interp_, name.c_str(), TCL_TRACE_WRITES, [](ClientData client_data, Tcl_Interp* interp, const char* name1, const char* name2, int flags) -> char* {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->double_callback_map_.find(name1);
-            if (it != self->double_callback_map_.end()) {
-                const char* val = Tcl_GetVar(interp, name1, TCL_GLOBAL_ONLY);
-                double v = val ? std::stod(val) : 0.0;
-                invoke_guarded([&]() { it->second(v); });
+        std::vector<Tcl_Obj*> objv;
+        std::vector<size_t>   sizes;
+        objv.swap(batch_objv_);
+        sizes.swap(batch_command_sizes_);
+
+        try
+        {
+            size_t offset = 0;
+            for (size_t n : sizes)
+            {
+                if (!eval_objv((int)n, objv.data() + offset))
+                    report_tcl_failure(*this, "batch", success);
+                offset += n;
             }
-            return nullptr;
-        }, this);
+        }
+        catch (...)
+        {
+            for (auto* obj : objv)
+                Tcl_DecrRefCount(obj);
+            throw;
+        }
+
+        for (auto* obj : objv)
+            Tcl_DecrRefCount(obj);
+    }
+
+    // 結果を使う呼び出しの直前に、溜めたコマンドを暗黙にflushする。溜めたコマンドの失敗は
+    // 呼び出し中の操作ではなく"batch"として(送出せずに)報告し、呼び出し自体はそのまま評価する
+    // (config()の失敗が直後のcget()の例外として現れ、cget()が実行されないことがないように)。
+    void flush_pending()
+    {
+        if (batch_objv_.empty())
+            return;
+        bool ok = true;
+        flush_batch(&ok);
+    }
+
+    // バッチ中(tk::Batchの生存期間)か。InterpreterClient::exec()がスレッド検査を省く判定に使う。
+    bool batching() const { return batch_depth_ > 0; }
+
+    // cacheが無効ならnameのコマンドを解決し直し、削除/renameトレースを張る。コマンドが
+    // (まだ)存在しなければfalseを返す。
+    bool resolve_command(WidgetCommandCache& cache, const std::string& name)
+    {
+        if (cache.valid)
+            return true;
+        if (!Tcl_GetCommandInfo(interp_, name.c_str(), &cache.info))
+            return false;
+        Tcl_TraceCommand(interp_, name.c_str(), command_trace_flags, &Interpreter::invalidate_command_cache, &cache);
+        cache.valid = true;
+        return true;
+    }
+
+    // Widget::Impl破棄時の後始末。path_objは評価に使われるとコマンド解決結果(インタプリタのCommandを指す
+    // 内部表現)を持つため、所有スレッドで解放する。cache->validは所有スレッドの削除トレースが書き換えるため、
+    // 所有スレッド以外では読まずに後始末ごとpost()で所有スレッドに回す(PendingWidgetObjects)。所有スレッドが
+    // 終了済み(retire())なら、Tclには触れずにcacheだけを解放する。cache/path_objはどちらもnullptrでよい。
+    void release_widget_objects(WidgetCommandCache* cache, Tcl_Obj* path_obj, const std::string& name)
+    {
+        if (owner_thread_ == std::this_thread::get_id())
+        {
+            drop_widget_objects(cache, path_obj, name);
+            return;
+        }
+        if (!alive())
+        {
+            delete cache;
+            return;
+        }
+        auto pending = std::make_shared<PendingWidgetObjects>(this, cache, path_obj, name);
+        std::function<void()> job = [pending]() {};
+        // jobが最後の参照を持つようにする。後始末はjobの破棄時に1度だけ行われる。
+        pending.reset();
+        post(std::move(job));
+    }
+
+    // exec()と同じだが、words[0]が指すコマンド(name)のobjProcを解決済みのcacheから直接呼ぶ
+    // (Tcl_EvalObjvによるコマンド名解決を省く)。バッチ中・未解決時はexec()に委ねる。
+    bool exec_direct(WidgetCommandCache& cache, const std::string& name, const std::vector<ArgValue>& words, Tcl_Obj* path)
+    {
+        if (batch_depth_ > 0 || !resolve_command(cache, name))
+            return exec(words, path);
+        flush_pending();
+
+        WordObjs objv(*this, words, path);
+
+        // Tcl_EvalObjvと同様、呼び出し前に前回の結果を消しておく(objProcは結果が空である前提で書かれている)。
+        Tcl_ResetResult(interp_);
+        int code = cache.info.objProc(cache.info.objClientData, interp_, objv.objc(), objv.objv());
+
+        bool ok = (code == TCL_OK);
+        if (!ok)
+            remember_failed_command(objv.objc(), objv.objv());
+        return ok;
+    }
+
+    // 直近に失敗したコマンドの語(remember_failed_command()参照)。
+    const std::vector<Tcl_Obj*>& failed_command() const
+    {
+        return failed_command_;
+    }
+
+    std::vector<std::string> failed_command_words() const
+    {
+        std::vector<std::string> words;
+        words.reserve(failed_command_.size());
+        for (auto* obj : failed_command_)
+        {
+            int len = 0;
+            const char* bytes = Tcl_GetStringFromObj(obj, &len);
+            words.emplace_back(bytes, (size_t)len);
+        }
+        return words;
+    }
+
+    // 結果のTcl_Obj自体(参照カウントは増やさない。保持する場合は呼び出し側で増やす)。
+    Tcl_Obj* result_obj() const
+    {
+        return Tcl_GetObjResult(interp_);
     }
 
-    void register_void_callback(const std::string& name, std::function<void()> callback)
+    // 長さ付きで読むため、Canvas::postscript等の大きな結果でもstrlenによる走査は発生しない。
+    std::string result_string() const
     {
-        void_callback_map_[name] = callback;
-        Tcl_CreateCommand(interp_, name.c_str(), [](ClientData client_data, Tcl_Interp*, int argc, const char* argv[]) -> int {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->void_callback_map_.find(argv[0]);
-            if (it != self->void_callback_map_.end())
+        int len = 0;
+        const char* bytes = Tcl_GetStringFromObj(Tcl_GetObjResult(interp_), &len);
+        return std::string(bytes, len);
+    }
+
+    // 直前のeval()の結果を、文字列表現を経由せずTcl_Objの内部表現から読む。Tk自身が
+    // Tcl_NewIntObj等で返した結果なら文字列表現は一度も生成されない。解釈できない値
+    // ("??"や空文字列等)はsafe_stol()/safe_stod()と同じく0/0.0/falseとして扱う。
+    int result_int() const
+    {
+        int v = 0;
+        if (Tcl_GetIntFromObj(nullptr, Tcl_GetObjResult(interp_), &v) != TCL_OK)
+            return 0;
+        return v;
+    }
+
+    double result_double() const
+    {
+        double v = 0.0;
+        if (Tcl_GetDoubleFromObj(nullptr, Tcl_GetObjResult(interp_), &v) != TCL_OK)
+            return 0.0;
+        return v;
+    }
+
+    bool result_bool() const
+    {
+        int v = 0;
+        if (Tcl_GetBooleanFromObj(nullptr, Tcl_GetObjResult(interp_), &v) != TCL_OK)
+            return false;
+        return v != 0;
+    }
+
+    // split_list()と同じくリストとして解釈できなければ空を返す。
+    std::vector<std::string> result_list() const
+    {
+        int objc = 0;
+        Tcl_Obj** objv = nullptr;
+        std::vector<std::string> result;
+        if (Tcl_ListObjGetElements(nullptr, Tcl_GetObjResult(interp_), &objc, &objv) == TCL_OK)
+        {
+            result.reserve(objc);
+            for (int i = 0; i < objc; ++i)
             {
-                invoke_guarded([&]() { it->second(); });
+                int len = 0;
+                const char* bytes = Tcl_GetStringFromObj(objv[i], &len);
+                result.emplace_back(bytes, len);
             }
-            return TCL_OK;
-        }, this, nullptr);
+        }
+        return result;
     }
 
-    void register_double_callback(const std::string& name, std::function<void(const double&)> callback)
+    // result_list()の要素をresult_int()と同じ規則で整数として読む(bbox/curselection等)。
+    std::vector<int> result_int_list() const
     {
-        double_callback_map_[name] = callback;
-        Tcl_CreateCommand(interp_, name.c_str(), [](ClientData client_data, Tcl_Interp*, int argc, const char* argv[]) -> int {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->double_callback_map_.find(argv[0]);
-            if (it != self->double_callback_map_.end())
+        int objc = 0;
+        Tcl_Obj** objv = nullptr;
+        std::vector<int> result;
+        if (Tcl_ListObjGetElements(nullptr, Tcl_GetObjResult(interp_), &objc, &objv) == TCL_OK)
+        {
+            result.reserve(objc);
+            for (int i = 0; i < objc; ++i)
             {
-                invoke_guarded([&]() { it->second(safe_stod(argv[1])); });
+                int v = 0;
+                result.push_back(Tcl_GetIntFromObj(nullptr, objv[i], &v) == TCL_OK ? v : 0);
             }
+        }
+        return result;
+    }
+
+    // Tclのリスト形式の文字列(要素にスペースを含む場合は{}や""で囲まれる)を、
+    // 単純な空白split(既存のwinfo_children等が使っている方式)では壊れてしまうため、
+    // Tcl_SplitListで正しく要素分解する。
+    std::vector<std::string> split_list(const std::string& list) const
+    {
+        int argc = 0;
+        const char** argv = nullptr;
+        std::vector<std::string> result;
+        if (Tcl_SplitList(interp_, list.c_str(), &argc, &argv) == TCL_OK)
+        {
+            result.reserve(argc);
+            for (int i = 0; i < argc; ++i)
+                result.emplace_back(argv[i]);
+            Tcl_Free(reinterpret_cast<char*>(argv));
+        }
+        return result;
+    }
+
+    void set_var(const std::string& name, const std::string& value)
+    {
+        Tcl_SetVar(interp_, name.c_str(), value.c_str(), TCL_GLOBAL_ONLY);
+    }
+    
+    std::string get_var(const std::string& name)
+    {
+        const char* val = Tcl_GetVar(interp_, name.c_str(), TCL_GLOBAL_ONLY);
+        return val ? val : "";
+    }
+
+    // 以下のtrace_var/register_*_callbackは、コールバックを1つずつCallbackSlotに格納し、
+    // そのポインタをトレース/コマンドのClientDataとして渡す。呼び出し時は名前で表を引かず、
+    // ClientDataを辿るだけで済む。同じ変数・同じ型への再トレースは前のコールバックを置き換える
+    // (前のスロットはTclのトレース削除に合わせて解放される)。
+    // register_*_callbackはコマンド名を受け取らず、Interpreterごとの連番のトークンを払い出して
+    // 返す(コマンド名はcallback_command_name()でトークンから作る)。トークンは再利用しないため、
+    // 古いスクリプトに残ったコマンド名が後から登録した別のコールバックを呼ぶことは無い。
+    // 置き換え・回収はadopt_callback()で登録先(ウィジェット)と役割を結び付けて行う。
+    void trace_var(const std::string& name, std::function<void(const std::string&)> callback)
+    {
+        replace_var_trace(name, &Interpreter::dispatch_var_trace<std::string>, new_var_trace_slot(std::move(callback)));
+    }
+
+    void trace_var(const std::string& name, std::function<void(const int&)> callback)
+    {
+        replace_var_trace(name, &Interpreter::dispatch_var_trace<int>, new_var_trace_slot(std::move(callback)));
+    }
+
+    void trace_var(const std::string& name, std::function<void(const double&)> callback)
+    {
+        replace_var_trace(name, &Interpreter::dispatch_var_trace<double>, new_var_trace_slot(std::move(callback)));
+    }
+
+    // trace_var()で張った変数nameのトレースを全て外す(tk::Varの最後のコピーの破棄時)。所有スレッド以外
+    // からはpost()で所有スレッドに回し、所有スレッドが終了済みなら何もしない(トレースはTcl_DeleteInterpで
+    // 解放済み)。
+    void release_var_traces(const std::string& name)
+    {
+        if (owner_thread_ != std::this_thread::get_id())
+        {
+            post([this, name]() { remove_var_traces(name); });
+            return;
+        }
+        if (alive())
+            remove_var_traces(name);
+    }
+
+    unsigned register_void_callback(std::function<void()> callback)
+    {
+        return create_callback_command(std::move(callback), [](ClientData client_data, Tcl_Interp*, int, Tcl_Obj* const objv[]) -> int {
+            auto* slot = static_cast<CallbackSlot<std::function<void()>>*>(client_data);
+            SlotCall in_call(slot);
+            invoke_guarded([&]() { slot->fn(); }, Tcl_GetString(objv[0]));
+            return TCL_OK;
+        });
+    }
+
+    unsigned register_double_callback(std::function<void(const double&)> callback)
+    {
+        return create_callback_command(std::move(callback), [](ClientData client_data, Tcl_Interp*, int objc, Tcl_Obj* const objv[]) -> int {
+            auto* slot = static_cast<CallbackSlot<std::function<void(const double&)>>*>(client_data);
+            SlotCall in_call(slot);
+            double value = (objc > 1) ? obj_double(objv[1]) : 0.0;
+            invoke_guarded([&]() { slot->fn(value); }, Tcl_GetString(objv[0]));
             return TCL_OK;
-        }, this, nullptr);
+        });
     }
 
-    void register_string_callback(const std::string& name, std::function<void(const std::string&)> callback)
+    unsigned register_string_callback(std::function<void(const std::string&)> callback)
     {
-        string_callback_map_[name] = callback;
-        Tcl_CreateCommand(interp_, name.c_str(), [](ClientData client_data, Tcl_Interp*, int argc, const char* argv[]) -> int {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->string_callback_map_.find(argv[0]);
-            if (it != self->string_callback_map_.end())
+        return create_callback_command(std::move(callback), [](ClientData client_data, Tcl_Interp*, int objc, Tcl_Obj* const objv[]) -> int {
+            auto* slot = static_cast<CallbackSlot<std::function<void(const std::string&)>>*>(client_data);
+            SlotCall in_call(slot);
+            std::string args;
+            for (int i = 1; i < objc; ++i)
             {
-                std::string args;
-                for (int i = 1; i < argc; ++i)
-                {
-                    if (i > 1) args += ' ';
-                    args += argv[i];
-                }
-                invoke_guarded([&]() { it->second(args); });
+                if (i > 1) args += ' ';
+                int len = 0;
+                const char* bytes = Tcl_GetStringFromObj(objv[i], &len);
+                args.append(bytes, len);
             }
+            invoke_guarded([&]() { slot->fn(args); }, Tcl_GetString(objv[0]));
             return TCL_OK;
-        }, this, nullptr);
+        });
+    }
+
+    // 引数はfieldsで選んだフィールドだけが(%x %y %X %Y %W %K %k %c %t %D)の順に並ぶ(event_script()参照)。
+    unsigned register_event_callback(std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE)
+    {
+        EventCallback event_callback;
+        event_callback.handler  = std::move(callback);
+        event_callback.fields   = fields;
+        event_callback.coalesce = coalesce;
+        event_callback.owner    = this;
+        return create_callback_command(std::move(event_callback), &Interpreter::dispatch_event);
     }
 
-    void register_event_callback(const std::string& name, std::function<void(const Event&)> callback)
+    // bind()に渡すスクリプト。コマンド名の後に、fieldsで選んだフィールドの置換(%x等)だけを並べる。
+    static std::string event_script(const std::string& command, EventField fields)
     {
-        event_callback_map_[name] = callback;
-        Tcl_CreateCommand(interp_, name.c_str(), [](ClientData client_data, Tcl_Interp*, int argc, const char* argv[]) -> int {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->event_callback_map_.find(argv[0]);
-            if (it != self->event_callback_map_.end())
+        static const char* const substitutions[] = {"%x", "%y", "%X", "%Y", "%W", "%K", "%k", "%c", "%t", "%D"};
+        std::string script = command;
+        for (unsigned bit = 0; bit < 10; ++bit)
+        {
+            if (static_cast<unsigned>(fields) & (1u << bit))
             {
-                auto e      = Event();
-                e.x         = safe_stol(argv[1]);
-                e.y         = safe_stol(argv[2]);
-                e.x_root    = safe_stol(argv[3]);
-                e.y_root    = safe_stol(argv[4]);
-                e.widget    = argv[5];
-                e.keysym    = argv[6];
-                e.keycode   = safe_stol(argv[7]);
-                e.character = argv[8];
-                e.type      = argv[9];
-                e.delta     = safe_stol(argv[10]);
-                invoke_guarded([&]() { it->second(e); });
+                script += ' ';
+                script += substitutions[bit];
             }
-            return TCL_OK;
-        }, this, nullptr);
+        }
+        return script;
+    }
+
+    static int event_field_count(EventField fields)
+    {
+        int count = 0;
+        for (unsigned bits = static_cast<unsigned>(fields & EventField::ALL); bits != 0; bits &= bits - 1)
+            ++count;
+        return count;
     }
 
     // Entry::validate()等、Tcl側にbool(0/1)を返す必要があるコールバック(validatecommand等)用。
     // 他のregister_*_callbackと異なり、Tclコマンドの戻り値そのものをcallbackの結果にする。
     // コールバックが例外を投げた場合はfalse(編集拒否)側にfail closedする。
-    void register_bool_callback(const std::string& name, std::function<bool(const std::string&)> callback)
-    {
-        bool_callback_map_[name] = callback;
-        Tcl_CreateCommand(interp_, name.c_str(), [](ClientData client_data, Tcl_Interp* interp, int argc, const char* argv[]) -> int {
-            auto* self = static_cast<Interpreter*>(client_data);
-            auto it = self->bool_callback_map_.find(argv[0]);
-            bool result = true;
-            if (it != self->bool_callback_map_.end())
+    unsigned register_bool_callback(std::function<bool(const std::string&)> callback)
+    {
+        return create_callback_command(std::move(callback), [](ClientData client_data, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]) -> int {
+            auto* slot = static_cast<CallbackSlot<std::function<bool(const std::string&)>>*>(client_data);
+            SlotCall in_call(slot);
+            std::string arg = (objc > 1) ? Tcl_GetString(objv[1]) : "";
+            bool ok = false;
+            invoke_guarded([&]() { ok = slot->fn(arg); }, Tcl_GetString(objv[0]));
+            Tcl_SetObjResult(interp, Tcl_NewBooleanObj(ok ? 1 : 0));
+            return TCL_OK;
+        });
+    }
+
+    // Widget::after()等、1回だけ呼ばれるコールバック用。呼び出し後に自分のコマンドを削除する
+    // (スロットは実行が終わってから解放される)。
+    unsigned register_oneshot_callback(std::function<void()> callback)
+    {
+        return create_callback_command(OneshotCallback{std::move(callback), this, std::string()}, &Interpreter::dispatch_oneshot);
+    }
+
+    // after()が返したidを、tokenのコールバックに結び付ける。after_cancel()はTclに問い合わせずにidから
+    // コールバックを引き、発火したコールバックは自分のidを外す。
+    void remember_after(const std::string& id, unsigned token)
+    {
+        Tcl_CmdInfo info;
+        if (!Tcl_GetCommandInfo(interp_, callback_command_name(token).c_str(), &info) || info.objProc != &Interpreter::dispatch_oneshot)
+            return;
+        static_cast<CallbackSlot<OneshotCallback>*>(info.objClientData)->fn.after_id = id;
+        after_ids_[id] = token;
+    }
+
+    // after_cancel()で取り消したidのコールバックを削除する。発火済み・取り消し済み・after()以外のidは何もしない。
+    void cancel_after(const std::string& id)
+    {
+        auto found = after_ids_.find(id);
+        if (found == after_ids_.end())
+            return;
+        unsigned token = found->second;
+        after_ids_.erase(found);
+        release_oneshot_callback(callback_command_name(token));
+    }
+
+    // nameが未実行のregister_oneshot_callback()のコマンドなら削除する(after cancel用)。
+    // それ以外のコマンドには触れない。
+    void release_oneshot_callback(const std::string& name)
+    {
+        Tcl_CmdInfo info;
+        if (Tcl_GetCommandInfo(interp_, name.c_str(), &info) && info.objProc == &Interpreter::dispatch_oneshot)
+            Tcl_DeleteCommand(interp_, name.c_str());
+    }
+
+    static std::string callback_command_name(unsigned token)
+    {
+        return "cpp_tk_cb" + std::to_string(token);
+    }
+
+    // トークンのコールバックを、ウィジェットownerの破棄(ウィジェットコマンドの削除)時に一緒に削除する
+    // よう登録し、コマンド名を返す。roleが空でなければ、同じownerとroleで前に登録したコールバックを
+    // 削除して置き換える(同じイベントへのbind、command()の再設定等)。ownerが空文字列の登録
+    // (bind_all/bind_class)は破棄されるウィジェットを持たず、置き換えだけを行う。ownerのコマンドが
+    // 存在しない(破棄済みのウィジェット等)場合はトレースを張らず、登録はrelease_state()で片付ける。
+    std::string adopt_callback(const std::string& owner, const std::string& role, unsigned token)
+    {
+        CallbackOwner*& record = callback_owners_[owner];
+        if (!record)
+        {
+            record = new CallbackOwner{this, owner, {}, {}, false};
+            g_callback_owners.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (role.empty())
+        {
+            record->anonymous.insert(token);
+        }
+        else
+        {
+            unsigned& slot = record->by_role[role];
+            if (slot != 0)
             {
-                std::string arg = (argc > 1) ? argv[1] : "";
-                bool ok = false;
-                invoke_guarded([&]() { ok = it->second(arg); });
-                result = ok;
+                callback_token_owners_.erase(slot);
+                Tcl_DeleteCommand(interp_, callback_command_name(slot).c_str());
             }
-            Tcl_SetObjResult(interp, Tcl_NewBooleanObj(result ? 1 : 0));
-            return TCL_OK;
-        }, this, nullptr);
+            slot = token;
+        }
+        callback_token_owners_[token] = record;
+        if (!owner.empty() && !record->traced)
+            trace_owner(record);
+        return callback_command_name(token);
+    }
+
+    // adopt_callback()でroleに登録したコールバックを、ownerの破棄を待たずに削除する(unbind等)。
+    void release_callback(const std::string& owner, const std::string& role)
+    {
+        auto it = callback_owners_.find(owner);
+        if (it == callback_owners_.end())
+            return;
+        auto found = it->second->by_role.find(role);
+        if (found == it->second->by_role.end())
+            return;
+        unsigned token = found->second;
+        it->second->by_role.erase(found);
+        callback_token_owners_.erase(token);
+        Tcl_DeleteCommand(interp_, callback_command_name(token).c_str());
+    }
+
+    // Timer::once()/every()の実処理。Tclのタイマを直接使い、Tclコマンドは作らない。
+    std::shared_ptr<TimerState> start_timer(int ms, bool periodic, std::function<void()> callback)
+    {
+        auto state = std::make_shared<TimerState>();
+        state->interp   = this;
+        state->callback = std::move(callback);
+        state->interval = std::chrono::milliseconds(ms);
+        state->due      = std::chrono::steady_clock::now() + state->interval;
+        state->periodic = periodic;
+        state->active   = true;
+        state->serial   = ++last_timer_serial_;
+        state->token    = Tcl_CreateTimerHandler(ms, &Interpreter::fire_timer, state.get());
+        timers_.emplace(state.get(), state);
+        g_callbacks_created.fetch_add(1, std::memory_order_relaxed);
+        return state;
+    }
+
+    void cancel_timer(TimerState* state)
+    {
+        if (!state->active)
+            return;
+        Tcl_DeleteTimerHandler(state->token);
+        finish_timer(state);
+    }
+
+    // schedule_idle()/enqueue_idle()のキューの1件。
+    struct IdleItem
+    {
+        std::string           key;       // schedule_idle()のkey(ライブラリ内部の処理では空)
+        bool                  internal;  // enqueue_idle()で載せたライブラリ内部の処理
+        std::function<void()> callback;
+    };
+
+    // schedule_idle()の実処理。同じkeyの要求は、キューの同じ位置のコールバックを差し替える。
+    bool schedule_idle(const std::string& key, std::function<void()> callback)
+    {
+        auto found = idle_index_.find(key);
+        if (found != idle_index_.end())
+        {
+            idle_queue_[found->second].callback = std::move(callback);
+            return false;
+        }
+        idle_index_.emplace(key, idle_queue_.size());
+        push_idle(IdleItem{key, false, std::move(callback)});
+        return true;
+    }
+
+    // ライブラリ内部(Coalesce::LATESTの配達)のアイドル処理。idle_index_に載せないため、利用者の
+    // schedule_idle()/cancel_idle()からは差し替えも取り消しもできない。計測は配達先のコールバックの
+    // キーで行うため、アイドル処理としては記録しない(同じ時間を二重に数えない)。
+    void enqueue_idle(std::function<void()> callback)
+    {
+        push_idle(IdleItem{std::string(), true, std::move(callback)});
+    }
+
+    void push_idle(IdleItem item)
+    {
+        idle_queue_.push_back(std::move(item));
+        g_callbacks_created.fetch_add(1, std::memory_order_relaxed);
+        if (!idle_scheduled_)
+        {
+            Tcl_DoWhenIdle(&Interpreter::drain_idle_queue, this);
+            idle_scheduled_ = true;
+        }
+    }
+
+    // 取り消した要素はキューから詰めずに空にしておき、drain_idle_queue()で読み飛ばす。
+    bool cancel_idle(const std::string& key)
+    {
+        auto found = idle_index_.find(key);
+        if (found == idle_index_.end())
+            return false;
+        idle_queue_[found->second].callback = nullptr;
+        idle_index_.erase(found);
+        g_callbacks_released.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // callback_command_name()の逆。コールバックのコマンド名でなければ0を返す。
+    static unsigned callback_token(const std::string& name)
+    {
+        static const char prefix[] = "cpp_tk_cb";
+        if (name.compare(0, sizeof(prefix) - 1, prefix) != 0)
+            return 0;
+        return (unsigned)std::strtoul(name.c_str() + sizeof(prefix) - 1, nullptr, 10);
+    }
+
+    // release_callback()のコマンド名版(Menu::erase等、項目から読み戻したコマンド名しか無い場合)。
+    // ownerがroleなしで登録したコールバックでなければ何もしない。
+    void release_callback_command(const std::string& owner, const std::string& name)
+    {
+        unsigned token = callback_token(name);
+        if (token == 0)
+            return;
+        auto it = callback_owners_.find(owner);
+        if (it == callback_owners_.end())
+            return;
+        if (it->second->anonymous.erase(token) == 0)
+            return;
+        callback_token_owners_.erase(token);
+        Tcl_DeleteCommand(interp_, name.c_str());
+    }
+
+    // tokenのコールバックの登録先を"<ウィジェットのパス> <役割>"で返す(役割の無いものはパスのみ、
+    // bind_all等のウィジェットに属さないものは役割のみ)。登録簿に無ければ空文字列。
+    // 逆引きで登録先を引き、役割はその登録先の中だけで探す。
+    std::string describe_callback(unsigned token) const
+    {
+        auto found = callback_token_owners_.find(token);
+        if (found == callback_token_owners_.end())
+            return std::string();
+        const CallbackOwner* record = found->second;
+        if (record->anonymous.count(token))
+            return record->path;
+        for (const auto& role : record->by_role)
+        {
+            if (role.second == token)
+                return record->path.empty() ? role.first : record->path + " " + role.first;
+        }
+        return std::string();
     }
 
 private:
-    // post()がTcl_ThreadQueueEventへ登録するイベント型。Tcl_Eventはヘッダ(header)を先頭に置いた
-    // C互換構造体であることが要求されるため、std::function自体は埋め込まずヒープに確保して
-    // ポインタだけを持たせる(Tcl_Alloc/Tcl_Freeで管理される領域にC++オブジェクトを直接
-    // 構築/破棄する事態を避けるため)。
-    struct PostedJobEvent
+    // コマンドの語をword_obj()でTcl_Objの配列に変換して参照カウントを保持し、破棄時に解放する。
+    // 典型的なコマンド(十数語まで)ではobjv自体のヒープ確保もしないよう、スタック上の配列を使う。
+    class WordObjs
     {
-        Tcl_Event               header;
-        std::function<void()>*  job;
+    public:
+        WordObjs(const Interpreter& owner, const std::vector<ArgValue>& words, Tcl_Obj* path)
+            : objc_((int)words.size())
+            , objv_(local_)
+        {
+            if (words.size() > max_local_words)
+            {
+                heap_.resize(words.size());
+                objv_ = heap_.data();
+            }
+            for (int i = 0; i < objc_; ++i)
+            {
+                objv_[i] = owner.word_obj(words[i], path);
+                Tcl_IncrRefCount(objv_[i]);
+            }
+        }
+
+        ~WordObjs()
+        {
+            for (int i = 0; i < objc_; ++i)
+                Tcl_DecrRefCount(objv_[i]);
+        }
+
+        WordObjs(const WordObjs&) = delete;
+
+        WordObjs& operator=(const WordObjs&) = delete;
+
+        int objc() const { return objc_; }
+
+        Tcl_Obj** objv() { return objv_; }
+
+    private:
+        static constexpr size_t max_local_words = 16;
+
+        int                   objc_;
+        Tcl_Obj**             objv_;
+        Tcl_Obj*              local_[max_local_words];
+        std::vector<Tcl_Obj*> heap_;
     };
 
-    // Tcl_ThreadQueueEventで注入されたjobをTclのイベントループ上(=生成スレッド上)で実行する。
-    // ここもTclのCコールスタックから直接呼ばれる境界なので、invoke_guarded経由で例外を握りつぶす。
-    static int handle_posted_job(Tcl_Event* evPtr, int /*flags*/)
+    // 組み立て済みの語を評価する。失敗時は語をremember_failed_command()で保持する(出力はしない)。
+    bool eval_objv(int objc, Tcl_Obj* const objv[])
     {
-        auto* pj = reinterpret_cast<PostedJobEvent*>(evPtr);
-        invoke_guarded([&]() { (*pj->job)(); });
-        delete pj->job;
-        return 1; // 1 = 処理済み。呼び出し元(Tcl本体)がこの戻り値を見てキューから取り除く。
+        int code = Tcl_EvalObjv(interp_, objc, objv, 0);
+
+        bool ok = (code == TCL_OK);
+        if (!ok)
+            remember_failed_command(objc, objv);
+        return ok;
     }
 
-    Tcl_Interp* interp_;
+    // 失敗したコマンドの語を、次に失敗するまで参照カウント付きで保持する。エラーの報告時
+    // (report_tcl_failure())にのみ、呼び出し箇所の判定と"(command: ...)"の整形に使う
+    // (失敗のたびに全語を文字列化してstderrへ書き出していたのをやめ、間引かれた失敗では整形しない)。
+    void remember_failed_command(int objc, Tcl_Obj* const objv[])
+    {
+        for (auto* obj : failed_command_)
+            Tcl_DecrRefCount(obj);
+        failed_command_.assign(objv, objv + objc);
+        for (auto* obj : failed_command_)
+            Tcl_IncrRefCount(obj);
+    }
 
-    std::thread::id owner_thread_;
+    static constexpr int command_trace_flags = TCL_TRACE_DELETE | TCL_TRACE_RENAME;
 
-    Tcl_ThreadId owner_tcl_thread_;
+    // ウィジェットの破棄(Tkはウィジェットコマンドを削除する)やrenameでキャッシュを無効化する。
+    // rename後もトレースは新しい名前のコマンドに付いたまま残るため、ここで外しておく
+    // (外さないと、キャッシュが解放された後にそのコマンドが削除された時に解放済みの領域へ書き込んでしまう)。
+    static void invalidate_command_cache(ClientData client_data, Tcl_Interp* interp, const char* /*old_name*/, const char* new_name, int flags)
+    {
+        auto* cache = static_cast<WidgetCommandCache*>(client_data);
+        cache->valid = false;
+        if ((flags & TCL_TRACE_RENAME) && new_name && *new_name)
+            Tcl_UntraceCommand(interp, new_name, command_trace_flags, &Interpreter::invalidate_command_cache, client_data);
+    }
+
+    // コマンドの語(トップレベルの要素)1つ分のTcl_Objを返す。STRINGの語がpathまたは
+    // interned_words_のいずれかと一致すればそれを(参照カウントを増やさずに)返し、
+    // それ以外はmake_obj()で新規生成する。呼び出し元はどちらの場合も同じように
+    // Tcl_IncrRefCount/Tcl_DecrRefCountしてよい。
+    Tcl_Obj* word_obj(const ArgValue& w, Tcl_Obj* path) const
+    {
+        if (w.type() == ArgValue::ValueType::STRING)
+        {
+            const std::string& s = w.as_string();
+            if (path)
+            {
+                int len = 0;
+                const char* bytes = Tcl_GetStringFromObj(path, &len);
+                if ((size_t)len == s.size() && std::memcmp(bytes, s.data(), s.size()) == 0)
+                    return path;
+            }
+            // 定型語はいずれも短いため、長い文字列(Text::insertの本文等)はハッシュ計算自体を省く。
+            if (s.size() <= max_interned_word_length)
+            {
+                auto it = interned_words_.find(s);
+                if (it != interned_words_.end())
+                    return it->second;
+            }
+        }
+        else if (w.type() == ArgValue::ValueType::STRING_REF)
+        {
+            // Optionsビルダーのオプション名は静的文字列へのStringRefとして渡ってくる。
+            const StringRef& ref = w.as_string_ref();
+            if (ref.size <= max_interned_word_length)
+            {
+                auto it = interned_words_.find(std::string(ref.data, ref.size));
+                if (it != interned_words_.end())
+                    return it->second;
+            }
+        }
+        return make_obj(interp_, w);
+    }
+
+    static constexpr size_t max_interned_word_length = 16;
 
-    std::unordered_map<std::string, std::function<void(const Event&)>>          event_callback_map_;
+    // CallbackSlotのうちコールバックの型によらない部分(実行中の数と解放の要求)。SlotCallが
+    // スロットの型を知らずに扱えるよう分けてある。
+    struct CallbackSlotState
+    {
+        int         active    = 0;
+        bool        released  = false;
+        unsigned    token     = 0;        // create_callback_command()で作ったコマンド・trace_var()のトークン(無ければ0)
+        bool        var_trace = false;    // 変数トレースのスロット(計測結果のキーは"trace <token>")
+        const char* aggregate = nullptr;  // 解放時にトークンの計測結果を合算する先(fold_callback_stats())
+    };
+
+    // コールバック1つ分の格納先(trace_var/register_*_callbackのClientData)。Tcl側のトレース/コマンドが
+    // 削除されるとrelease()が呼ばれるが、そのコールバックの実行中(自分自身を再登録した場合等)は
+    // 実行が終わるまで解放を遅らせる(SlotCall参照)。
+    template<typename Fn>
+    struct CallbackSlot
+    {
+        explicit CallbackSlot(Fn f)
+            : fn(std::move(f))
+        {
+            g_callbacks_created.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~CallbackSlot()
+        {
+            g_callbacks_released.fetch_add(1, std::memory_order_relaxed);
+            if (state.token != 0 && !t_callback_profile.empty())
+                fold_callback_stats(slot_profile_key(state), state.aggregate);
+        }
+
+        static void destroy(void* p) { delete static_cast<CallbackSlot*>(p); }
+
+        static void release(ClientData client_data)
+        {
+            auto* slot = static_cast<CallbackSlot*>(client_data);
+            slot->state.released = true;
+            if (slot->state.active == 0)
+                delete slot;
+        }
+
+        CallbackSlotState state;
+        Fn                fn;
+    };
+
+    // register_oneshot_callback()のスロットの中身。after()のコールバックなら、そのidも持つ(remember_after())。
+    struct OneshotCallback
+    {
+        std::function<void()> fn;
+        Interpreter*          owner;
+        std::string           after_id;
+    };
+
+    // register_event_callback()のスロットの中身。置換させたフィールドの選択も一緒に持つ。
+    // Coalesce::LATESTなら、届けるまでの最新のイベント(latest)とまとめた数もここに溜める。
+    struct EventCallback
+    {
+        std::function<void(const Event&)> handler;
+        EventField                        fields   = EventField::ALL;
+        Coalesce                          coalesce = Coalesce::NONE;
+        Interpreter*                      owner    = nullptr;   // スロットを登録したInterpreter(配達の予約先)
+        bool                              pending  = false;
+        Event                             latest   = Event();
+    };
+
+    static int dispatch_event(ClientData client_data, Tcl_Interp* /*interp*/, int objc, Tcl_Obj* const objv[])
+    {
+        auto* slot = static_cast<CallbackSlot<EventCallback>*>(client_data);
+        EventCallback& callback = slot->fn;
+        const EventField fields = callback.fields;
+        if (objc < 1 + event_field_count(fields))
+            return TCL_OK;
+        SlotCall in_call(slot);
+        auto e = Event();
+        int i = 1;
+        if (has_event_field(fields, EventField::X))         e.x         = obj_int(objv[i++]);
+        if (has_event_field(fields, EventField::Y))         e.y         = obj_int(objv[i++]);
+        if (has_event_field(fields, EventField::X_ROOT))    e.x_root    = obj_int(objv[i++]);
+        if (has_event_field(fields, EventField::Y_ROOT))    e.y_root    = obj_int(objv[i++]);
+        if (has_event_field(fields, EventField::WIDGET))    e.widget    = Tcl_GetString(objv[i++]);
+        if (has_event_field(fields, EventField::KEYSYM))    e.keysym    = Tcl_GetString(objv[i++]);
+        if (has_event_field(fields, EventField::KEYCODE))   e.keycode   = obj_int(objv[i++]);
+        if (has_event_field(fields, EventField::CHARACTER)) e.character = Tcl_GetString(objv[i++]);
+        if (has_event_field(fields, EventField::TYPE))      e.type      = Tcl_GetString(objv[i++]);
+        if (has_event_field(fields, EventField::DELTA))     e.delta     = obj_int(objv[i++]);
+
+        if (callback.coalesce != Coalesce::LATEST)
+        {
+            invoke_guarded([&]() { callback.handler(e); }, Tcl_GetString(objv[0]));
+            return TCL_OK;
+        }
+        // 届ける前のイベントは新しいもので上書きし、上書きした数を数える。アイドル時の配達はキューの
+        // 1件だけで済むよう、溜め始めた時に1回だけ予約する。
+        if (callback.pending)
+        {
+            e.coalesced = callback.latest.coalesced + 1;
+        }
+        else
+        {
+            callback.pending = true;
+            std::string name = Tcl_GetString(objv[0]);
+            Interpreter* self = callback.owner;
+            self->enqueue_idle([self, name]() { self->deliver_coalesced_event(name); });
+        }
+        callback.latest = std::move(e);
+        return TCL_OK;
+    }
+
+    // Coalesce::LATESTのアイドル時の配達。予約からここまでの間にunbind等でコマンドが削除されていれば
+    // (スロットも解放済みなので)何もしない。
+    void deliver_coalesced_event(const std::string& name)
+    {
+        Tcl_CmdInfo info;
+        if (!Tcl_GetCommandInfo(interp_, name.c_str(), &info) || info.objProc != &Interpreter::dispatch_event)
+            return;
+        auto* slot = static_cast<CallbackSlot<EventCallback>*>(info.objClientData);
+        EventCallback& callback = slot->fn;
+        if (!callback.pending)
+            return;
+        SlotCall in_call(slot);
+        callback.pending = false;
+        Event e = std::move(callback.latest);
+        callback.latest = Event();
+        invoke_guarded([&]() { callback.handler(e); }, name.c_str());
+    }
+
+    // ディスパッチ中のスロットを解放から守る。
+    class SlotCall
+    {
+    public:
+        template<typename Fn>
+        explicit SlotCall(CallbackSlot<Fn>* slot)
+            : state_(&slot->state)
+            , destroy_(&CallbackSlot<Fn>::destroy)
+            , slot_(slot)
+        {
+            ++state_->active;
+        }
+
+        ~SlotCall()
+        {
+            if (--state_->active == 0 && state_->released)
+                destroy_(slot_);
+        }
+
+        SlotCall(const SlotCall&) = delete;
+        SlotCall& operator=(const SlotCall&) = delete;
+
+    private:
+        CallbackSlotState* state_;
+        void             (*destroy_)(void*);
+        void*              slot_;
+    };
+
+    template<typename Fn>
+    unsigned create_callback_command(Fn callback, Tcl_ObjCmdProc* proc)
+    {
+        unsigned token = ++last_callback_token_;
+        auto* slot = new CallbackSlot<Fn>(std::move(callback));
+        slot->state.token     = token;
+        slot->state.aggregate = (proc == &Interpreter::dispatch_oneshot) ? "after" : "released";
+        Tcl_CreateObjCommand(interp_, callback_command_name(token).c_str(), proc, slot, &CallbackSlot<Fn>::release);
+        return token;
+    }
+
+    // 変数の削除(unset・インタプリタの破棄)でもスロットを解放できるよう、書き込みに加えてunsetも捕捉する。
+    static constexpr int var_trace_flags = TCL_GLOBAL_ONLY | TCL_TRACE_WRITES | TCL_TRACE_UNSETS;
+
+    // 変数トレースのスロットにも、計測結果のキー("trace <token>")用にコマンドと同じ連番のトークンを振る。
+    template<typename Fn>
+    CallbackSlot<Fn>* new_var_trace_slot(Fn callback)
+    {
+        auto* slot = new CallbackSlot<Fn>(std::move(callback));
+        slot->state.token     = ++last_callback_token_;
+        slot->state.var_trace = true;
+        slot->state.aggregate = "trace";
+        return slot;
+    }
+
+    static std::string slot_profile_key(const CallbackSlotState& state)
+    {
+        return state.var_trace ? "trace " + std::to_string(state.token) : callback_command_name(state.token);
+    }
+
+    template<typename Fn>
+    void replace_var_trace(const std::string& name, Tcl_VarTraceProc* proc, CallbackSlot<Fn>* slot)
+    {
+        remove_var_trace<Fn>(name, proc);
+        Tcl_TraceVar(interp_, name.c_str(), var_trace_flags, proc, slot);
+    }
+
+    // procで張った変数nameのトレースを外し、そのスロットを解放する(Tcl_UntraceVarはトレースの
+    // 手続きを呼ばないため、TCL_TRACE_DESTROYEDによる解放は起きない)。
+    template<typename Fn>
+    void remove_var_trace(const std::string& name, Tcl_VarTraceProc* proc)
+    {
+        ClientData previous = Tcl_VarTraceInfo(interp_, name.c_str(), TCL_GLOBAL_ONLY, proc, nullptr);
+        if (!previous)
+            return;
+        Tcl_UntraceVar(interp_, name.c_str(), var_trace_flags, proc, previous);
+        CallbackSlot<Fn>::release(previous);
+    }
+
+    void remove_var_traces(const std::string& name)
+    {
+        remove_var_trace<std::function<void(const std::string&)>>(name, &Interpreter::dispatch_var_trace<std::string>);
+        remove_var_trace<std::function<void(const int&)>>(name, &Interpreter::dispatch_var_trace<int>);
+        remove_var_trace<std::function<void(const double&)>>(name, &Interpreter::dispatch_var_trace<double>);
+    }
+
+    template<typename T>
+    static char* dispatch_var_trace(ClientData client_data, Tcl_Interp* interp, const char* name1, const char* name2, int flags)
+    {
+        typedef CallbackSlot<std::function<void(const T&)>> Slot;
+        auto* slot = static_cast<Slot*>(client_data);
+        if (flags & TCL_TRACE_UNSETS)
+        {
+            if (flags & TCL_TRACE_DESTROYED)
+                Slot::release(slot);
+            return nullptr;
+        }
+        SlotCall in_call(slot);
+        T value = T();
+        read_trace_value(Tcl_GetVar2Ex(interp, name1, name2, TCL_GLOBAL_ONLY), value);
+        // 計測はスロットごとのキーに、変数名を説明として記録する。スロットの解放時に"trace"へ合算される。
+        if (g_callback_profiling.load(std::memory_order_relaxed))
+            invoke_guarded([&]() { slot->fn(value); }, slot_profile_key(slot->state).c_str(), name1);
+        else
+            invoke_guarded([&]() { slot->fn(value); });
+        return nullptr;
+    }
+
+    // コールバック引数・変数値の読み取り。result_int()/result_double()と同じく、解釈できない値は0/0.0とする。
+    static int obj_int(Tcl_Obj* obj)
+    {
+        int v = 0;
+        if (Tcl_GetIntFromObj(nullptr, obj, &v) != TCL_OK)
+            return 0;
+        return v;
+    }
+
+    static double obj_double(Tcl_Obj* obj)
+    {
+        double v = 0.0;
+        if (Tcl_GetDoubleFromObj(nullptr, obj, &v) != TCL_OK)
+            return 0.0;
+        return v;
+    }
+
+    static void read_trace_value(Tcl_Obj* obj, std::string& value)
+    {
+        if (!obj)
+            return;
+        int len = 0;
+        const char* bytes = Tcl_GetStringFromObj(obj, &len);
+        value.assign(bytes, len);
+    }
+
+    static void read_trace_value(Tcl_Obj* obj, int& value)    { value = obj ? obj_int(obj) : 0; }
+
+    static void read_trace_value(Tcl_Obj* obj, double& value) { value = obj ? obj_double(obj) : 0.0; }
+
+    static int dispatch_oneshot(ClientData client_data, Tcl_Interp* interp, int, Tcl_Obj* const objv[])
+    {
+        auto* slot = static_cast<CallbackSlot<OneshotCallback>*>(client_data);
+        SlotCall in_call(slot);
+        if (!slot->fn.after_id.empty())
+            slot->fn.owner->after_ids_.erase(slot->fn.after_id);
+        Tcl_DeleteCommand(interp, Tcl_GetString(objv[0]));
+        invoke_guarded([&]() { slot->fn.fn(); }, Tcl_GetString(objv[0]));
+        return TCL_OK;
+    }
+
+    // 所有スレッド上でのrelease_widget_objects()の実処理。キャッシュが有効ならトレースがまだcacheを指して
+    // いるので外してから解放する。Tcl_Interpが破棄済みならTclには触れず、path_objは手放す。
+    void drop_widget_objects(WidgetCommandCache* cache, Tcl_Obj* path_obj, const std::string& name)
+    {
+        if (!alive())
+        {
+            delete cache;
+            return;
+        }
+        if (path_obj)
+            Tcl_DecrRefCount(path_obj);
+        if (!cache)
+            return;
+        if (cache->valid)
+            Tcl_UntraceCommand(interp_, name.c_str(), command_trace_flags, &Interpreter::invalidate_command_cache, cache);
+        delete cache;
+    }
+
+    // 他スレッドで破棄されたWidget::Implの後始末をpost()のjobに持たせる。後始末はjobの破棄(実行後、
+    // reset_interpreter()/retire()による未実行のままの破棄)に結び付け、実行されずに捨てられても行われる。
+    // 所有スレッド以外で破棄されるのは、所有スレッドの終了でpost()がjobを受け付けなかった場合だけなので、
+    // その場合はTclに触れずにcacheだけを解放する。Interpreterオブジェクトは解放されないため、ownerは常に有効。
+    struct PendingWidgetObjects
+    {
+        PendingWidgetObjects(Interpreter* owner, WidgetCommandCache* cache, Tcl_Obj* path_obj, const std::string& name)
+            : owner(owner)
+            , cache(cache)
+            , path_obj(path_obj)
+            , name(name)
+        {}
+
+        PendingWidgetObjects(const PendingWidgetObjects&) = delete;
+
+        PendingWidgetObjects& operator=(const PendingWidgetObjects&) = delete;
+
+        ~PendingWidgetObjects()
+        {
+            if (owner->owner_thread_ == std::this_thread::get_id())
+                owner->drop_widget_objects(cache, path_obj, name);
+            else
+                delete cache;
+        }
+
+        Interpreter*        owner;
+        WidgetCommandCache* cache;
+        Tcl_Obj*            path_obj;
+        std::string         name;
+    };
+
+    // adopt_callback()の登録簿の1件(ウィジェット1つ分)。ウィジェットコマンドの削除トレースのClientData。
+    struct CallbackOwner
+    {
+        Interpreter*                              self;
+        std::string                               path;
+        std::unordered_map<std::string, unsigned> by_role;
+        std::unordered_set<unsigned>              anonymous;
+        bool                                      traced;
+    };
+
+    void trace_owner(CallbackOwner* record)
+    {
+        Tcl_CmdInfo info;
+        if (!Tcl_GetCommandInfo(interp_, record->path.c_str(), &info))
+            return;
+        Tcl_TraceCommand(interp_, record->path.c_str(), TCL_TRACE_DELETE, &Interpreter::release_owned_callbacks, record);
+        record->traced = true;
+    }
+
+    void forget_owner(CallbackOwner* record)
+    {
+        for (const auto& kv : record->by_role)
+            callback_token_owners_.erase(kv.second);
+        for (unsigned token : record->anonymous)
+            callback_token_owners_.erase(token);
+        auto it = callback_owners_.find(record->path);
+        if (it != callback_owners_.end() && it->second == record)
+            callback_owners_.erase(it);
+        delete record;
+        g_callback_owners.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // ウィジェットの破棄で、そのウィジェットに登録したコールバックのコマンドをまとめて削除する
+    // (各スロットはコマンドの削除に合わせて解放される)。インタプリタの破棄中は、コマンドは
+    // どのみち削除されるので登録簿だけ片付ける。
+    static void release_owned_callbacks(ClientData client_data, Tcl_Interp* interp, const char* /*old_name*/, const char* /*new_name*/, int /*flags*/)
+    {
+        auto* record = static_cast<CallbackOwner*>(client_data);
+        if (!Tcl_InterpDeleted(interp))
+        {
+            for (const auto& kv : record->by_role)
+                Tcl_DeleteCommand(interp, callback_command_name(kv.second).c_str());
+            for (unsigned token : record->anonymous)
+                Tcl_DeleteCommand(interp, callback_command_name(token).c_str());
+        }
+        record->self->forget_owner(record);
+    }
+
+    // 予約を終える(取り消し・onceの発火)。コールバックの実行中なら、その解放は実行後に回す。
+    // 一覧から外すため、呼び出し後のstateはハンドル等が別に保持していなければ無効になる。
+    void finish_timer(TimerState* state)
+    {
+        state->active = false;
+        state->token  = nullptr;
+        if (state->running == 0)
+            drop_timer_callback(state);
+        timers_.erase(state);
+    }
+
+    static void drop_timer_callback(TimerState* state)
+    {
+        if (!state->callback)
+            return;
+        state->callback = nullptr;
+        g_callbacks_released.fetch_add(1, std::memory_order_relaxed);
+        if (!t_callback_profile.empty())
+            fold_callback_stats(timer_profile_key(state), "timer");
+    }
+
+    static std::string timer_profile_key(const TimerState* state)
+    {
+        return "timer " + std::to_string(state->serial);
+    }
+
+    // 周期タイマは、コールバックより先に次の周期を予約する(コールバック内のcancel()で取り消せるように)。
+    // 次の予定時刻は前回の予定時刻に周期を足して決め、実際に呼ばれた時刻の遅れは持ち越さない。
+    static void fire_timer(ClientData client_data)
+    {
+        auto* state = static_cast<TimerState*>(client_data);
+        Interpreter* self = state->interp;
+        auto found = self->timers_.find(state);
+        if (found == self->timers_.end())
+            return;
+        std::shared_ptr<TimerState> keep = found->second;
+        state->token = nullptr;
+        if (state->periodic)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            state->due += state->interval;
+            if (state->due <= now)
+                state->due += ((now - state->due) / state->interval + 1) * state->interval;
+            auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(state->due - now);
+            state->token = Tcl_CreateTimerHandler((int)delay.count(), &Interpreter::fire_timer, state);
+        }
+        else
+        {
+            state->active = false;
+            self->timers_.erase(state);
+        }
+        ++state->running;
+        if (g_callback_profiling.load(std::memory_order_relaxed))
+            invoke_guarded([&]() { state->callback(); }, timer_profile_key(state).c_str());
+        else
+            invoke_guarded([&]() { state->callback(); });
+        --state->running;
+        if (!state->active && state->running == 0)
+            drop_timer_callback(state);
+    }
+
+    // キューを取り出してから実行するため、実行中のschedule_idle()は新しいキューに載り、次のアイドル時に回る
+    // (Tclは実行中のアイドル処理の中で登録されたアイドル処理を、同じ回には呼ばない)。
+    static void drain_idle_queue(ClientData client_data)
+    {
+        auto* self = static_cast<Interpreter*>(client_data);
+        std::vector<IdleItem> queue;
+        queue.swap(self->idle_queue_);
+        self->idle_index_.clear();
+        self->idle_scheduled_ = false;
+        for (auto& item : queue)
+        {
+            if (!item.callback)
+                continue;
+            // keyは利用者が自由に作れる(オブジェクトごとのkey等)ため、post()と同じく実行のたびに"idle"へ合算する。
+            if (!item.internal && g_callback_profiling.load(std::memory_order_relaxed))
+            {
+                const std::string key = "idle " + item.key;
+                invoke_guarded(item.callback, key.c_str());
+                fold_callback_stats(key, "idle");
+            }
+            else
+            {
+                invoke_guarded(item.callback);
+            }
+            g_callbacks_released.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 実行されずに捨てる場合(reset_interpreter()・Interpreterの破棄)用。アイドル処理もタイマと同じく
+    // スレッドに属するため、Tcl_DeleteInterpでは消えない。
+    void discard_idle_queue()
+    {
+        if (idle_scheduled_)
+            Tcl_CancelIdleCall(&Interpreter::drain_idle_queue, this);
+        idle_scheduled_ = false;
+        for (auto& item : idle_queue_)
+        {
+            if (item.callback)
+                g_callbacks_released.fetch_add(1, std::memory_order_relaxed);
+        }
+        idle_queue_.clear();
+        idle_index_.clear();
+    }
+
+    // post()がTcl_ThreadQueueEventへ登録するイベント型。Tcl_Eventはヘッダ(header)を先頭に置いた
+    // C互換構造体であることが要求されるため、std::function自体は埋め込まずヒープに確保して
+    // ポインタだけを持たせる(Tcl_Alloc/Tcl_Freeで管理される領域にC++オブジェクトを直接
+    // 構築/破棄する事態を避けるため)。
+    struct PostedJobEvent
+    {
+        Tcl_Event               header;
+        std::function<void()>*  job;
+        unsigned long           serial;  // 計測結果のキー("post <serial>")
+    };
+
+    // Tcl_ThreadQueueEventで注入されたjobをTclのイベントループ上(=生成スレッド上)で実行する。
+    // ここもTclのCコールスタックから直接呼ばれる境界なので、invoke_guarded経由で例外を握りつぶす。
+    static int handle_posted_job(Tcl_Event* evPtr, int /*flags*/)
+    {
+        auto* pj = reinterpret_cast<PostedJobEvent*>(evPtr);
+        if (g_callback_profiling.load(std::memory_order_relaxed))
+        {
+            const std::string key = "post " + std::to_string(pj->serial);
+            invoke_guarded([&]() { (*pj->job)(); }, key.c_str());
+            fold_callback_stats(key, "post");
+        }
+        else
+        {
+            invoke_guarded([&]() { (*pj->job)(); });
+        }
+        delete pj->job;
+        return 1; // 1 = 処理済み。呼び出し元(Tcl本体)がこの戻り値を見てキューから取り除く。
+    }
+
+    // reset()用のTcl_DeleteEvents述語。未実行のpost()のjobを実行せずに解放し、キューから取り除かせる。
+    static int discard_posted_job(Tcl_Event* evPtr, ClientData /*client_data*/)
+    {
+        if (evPtr->proc != &Interpreter::handle_posted_job)
+            return 0;
+        delete reinterpret_cast<PostedJobEvent*>(evPtr)->job;
+        return 1;
+    }
+
+    // g_interp_init_mutexを保持した状態で呼ぶ。失敗した場合はTcl_Interpを破棄してから送出する。
+    void create_interp(bool with_tk)
+    {
+        interp_ = Tcl_CreateInterp();
+        if (!g_tcl_library_override.empty())
+            Tcl_SetVar(interp_, "tcl_library", g_tcl_library_override.c_str(), TCL_GLOBAL_ONLY);
+        if (Tcl_Init(interp_) != TCL_OK)
+        {
+            std::string message = "Tcl_Init failed: " + std::string(Tcl_GetStringResult(interp_));
+            Tcl_DeleteInterp(interp_);
+            interp_ = nullptr;
+            throw Error(message);
+        }
+        if (with_tk && !init_tk())
+        {
+            std::string message = "Tk_Init failed: " + std::string(Tcl_GetStringResult(interp_));
+            Tcl_DeleteInterp(interp_);
+            interp_ = nullptr;
+            throw Error(message);
+        }
+    }
+
+    void intern_words()
+    {
+        for (const char* word : interned_words)
+        {
+            Tcl_Obj*& obj = interned_words_[word];
+            if (obj)
+                continue;
+            obj = Tcl_NewStringObj(word, -1);
+            Tcl_IncrRefCount(obj);
+        }
+    }
+
+    // Tcl_Interpに結び付いた状態(溜めたバッチ・直近の失敗コマンド)を解放する。コールバックの
+    // スロットはTcl_DeleteInterpによるコマンド・トレースの削除に合わせて解放される。
+    // バッチの入れ子の深さは、生存中のtk::Batchが後で戻すためそのまま残す。
+    void release_state()
+    {
+        for (auto* obj : batch_objv_)
+            Tcl_DecrRefCount(obj);
+        batch_objv_.clear();
+        batch_command_sizes_.clear();
+        for (auto* obj : failed_command_)
+            Tcl_DecrRefCount(obj);
+        failed_command_.clear();
+        // トレースを張れていない登録簿(ウィジェットに属さないbind_all/bind_class用を含む)は
+        // Tcl_DeleteInterpで片付かないため、ここで解放する。
+        std::vector<CallbackOwner*> untraced;
+        for (const auto& kv : callback_owners_)
+        {
+            if (!kv.second->traced)
+                untraced.push_back(kv.second);
+        }
+        for (auto* record : untraced)
+            forget_owner(record);
+        // Tclのタイマはインタプリタではなくスレッドに属するため、Tcl_DeleteInterpでは消えない。
+        for (auto& kv : timers_)
+        {
+            Tcl_DeleteTimerHandler(kv.first->token);
+            kv.first->active = false;
+            kv.first->token  = nullptr;
+            drop_timer_callback(kv.first);
+        }
+        timers_.clear();
+        discard_idle_queue();
+        // after()のコールバックのコマンドはTcl_DeleteInterpと一緒に消える。
+        after_ids_.clear();
+    }
+
+    // g_interp_init_mutexを保持した状態で呼ぶ。失敗時はinterp_の結果にエラーメッセージが残る。
+    bool init_tk()
+    {
+        if (!g_tk_library_override.empty())
+            Tcl_SetVar(interp_, "tk_library", g_tk_library_override.c_str(), TCL_GLOBAL_ONLY);
+        if (Tk_Init(interp_) != TCL_OK)
+            return false;
+        has_tk_ = true;
+        return true;
+    }
+
+    Tcl_Interp* interp_;
+
+    bool has_tk_;
+
+    std::thread::id owner_thread_;
+
+    Tcl_ThreadId owner_tcl_thread_;
+
+    // retire()で下ろす。post()は他スレッドから呼ばれるため、判定と注入をpost_mutex_で直列化する。
+    std::atomic<bool> alive_{true};
+
+    std::mutex post_mutex_;
+
+    std::unordered_map<std::string, Tcl_Obj*>                                   interned_words_;
+
+    // バッチ中に溜めたコマンド。全コマンドの語を1本の配列に連結し、各コマンドの語数を別に持つ
+    // (コマンドごとにvectorを確保しないため)。
+    int                                                                         batch_depth_ = 0;
+
+    std::vector<Tcl_Obj*>                                                       batch_objv_;
+
+    std::vector<size_t>                                                         batch_command_sizes_;
+
+    std::vector<Tcl_Obj*>                                                       failed_command_;
+
+    unsigned                                                                    last_callback_token_ = 0;
+
+    std::unordered_map<TimerState*, std::shared_ptr<TimerState>>                timers_;
+
+    unsigned                                                                    last_timer_serial_ = 0;
+
+    std::unordered_map<std::string, unsigned>                                   after_ids_;    // after()が返した未発火のid -> コールバックのトークン
+
+    std::vector<IdleItem>                                                       idle_queue_;
+
+    std::unordered_map<std::string, std::size_t>                                idle_index_;   // 実行待ちのkey -> idle_queue_の位置
+
+    bool                                                                        idle_scheduled_ = false;
+
+    std::unordered_map<std::string, CallbackOwner*>                             callback_owners_;
+
+    // トークンから登録先を引く逆引き(describe_callback()用)。登録簿の変更と一緒に更新する。
+    std::unordered_map<unsigned, CallbackOwner*>                                callback_token_owners_;
+};
+
+// 呼び出し箇所は操作名と失敗したコマンドの先頭2語(通常はウィジェットパスとサブコマンド)で判定する。
+// 間引かれた失敗では、Tclのエラーメッセージのコピーもコマンドの整形も行わない。
+static void report_tcl_failure(const Interpreter& p, const char* operation, bool* success)
+{
+    std::uint64_t key = hash_bytes(error_site_seed, operation, std::strlen(operation));
+    const auto& words = p.failed_command();
+    for (size_t i = 0; i < words.size() && i < 2; ++i)
+    {
+        int len = 0;
+        const char* bytes = Tcl_GetStringFromObj(words[i], &len);
+        key = hash_bytes(key, bytes, (size_t)len);
+    }
+
+    const bool strict = !success && !has_error_policy(error_policy(), ErrorPolicy::LENIENT_CALL);
+    std::size_t suppressed = 0;
+    const bool report = should_report(key, &suppressed);
+    if (!report && !strict)
+    {
+        if (success) *success = false;
+        return;
+    }
+
+    // Tcl_Objは所有スレッドでしか読めず、記録はdrain_errors()で他スレッドから読まれるため、語とエラー
+    // メッセージはここで文字列として取り出す(1行への連結と整形は読まれる時まで行わない)。
+    ErrorRecord record{ErrorPolicy::LENIENT_CALL, ErrorRecord::Kind::TCL_FAILURE, operation, nullptr,
+                       p.result_string(), report ? p.failed_command_words() : std::vector<std::string>(),
+                       suppressed, std::this_thread::get_id()};
+    if (!strict)
+    {
+        dispatch_error(std::move(record));
+        if (success) *success = false;
+        return;
+    }
+    std::string message = record.what() + ": " + record.detail;
+    if (report)
+        dispatch_error(std::move(record));
+    throw Error(message);
+}
+
+// 静的初期化を行うスレッド(通常はメインスレッド)のID。InterpreterThreadExitの対象から外すために使う。
+static const std::thread::id g_main_thread_id = std::this_thread::get_id();
+
+// スレッドの終了時に、そのスレッドのInterpreterを登録簿から外してTcl_Interpを破棄する(Interpreter::retire())。
+// Tcl_CreateThreadExitHandlerはTcl_FinalizeThreadを呼ばないstd::threadでは呼ばれないため、thread_localの
+// デストラクタを終了フックとして使う。メインスレッドではexit()の途中で呼ばれ、その後に破棄される静的な
+// Widget等がまだInterpreterを使うため、何もしない。
+struct InterpreterThreadExit
+{
+    InterpreterThreadExit()
+    {
+        // retire()は計測結果を畳み込むため、t_callback_profileを先に構築させてこれより後に破棄させる。
+        (void)t_callback_profile.size();
+    }
+
+    ~InterpreterThreadExit()
+    {
+        if (!t_interp || std::this_thread::get_id() == g_main_thread_id)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(g_interp_registry_mutex);
+            g_interp_registry.erase(std::this_thread::get_id());
+        }
+        t_interp->retire();
+        t_interp = nullptr;
+    }
+};
+
+static thread_local InterpreterThreadExit t_interp_thread_exit;
+
+// Interpreterはスレッドごとにちょうど1つだけ存在する遅延生成のシングルトン。
+// 呼び出しスレッドに紐づくInterpreterが無ければこの場で生成して登録するため、
+// current_interp()は常に有効なポインタを返す(nullptrにはならない)。tk::Tkの構築を
+// 待たずにVar/PhotoImage/font::Font/ttk::Styleを構築しても、その場でInterpreterが
+// 用意される。同一スレッドでtk::Tkを複数回構築しても、この関数が返す既存の
+// Interpreterを再利用するだけなので上書き・迷子になったInterpreterは発生しない。
+static Interpreter* register_interp(Interpreter* interp)
+{
+    (void)&t_interp_thread_exit;  // 終了フックをこのスレッドで構築させる
+    t_interp = interp;
+    std::lock_guard<std::mutex> lock(g_interp_registry_mutex);
+    g_interp_registry[std::this_thread::get_id()] = t_interp;
+    return t_interp;
+}
+
+Interpreter* current_interp()
+{
+    if (t_interp)
+        return t_interp;
+    return register_interp(new Interpreter());
+}
+
+void reset_interpreter()
+{
+    if (!t_interp)
+    {
+        current_interp();
+        return;
+    }
+    t_interp->reset();
+}
+
+Stats stats()
+{
+    Stats result;
+    result.callbacks_created  = g_callbacks_created.load(std::memory_order_relaxed);
+    result.callbacks_released = g_callbacks_released.load(std::memory_order_relaxed);
+    result.live_callbacks     = result.callbacks_created - result.callbacks_released;
+    result.callback_owners    = g_callback_owners.load(std::memory_order_relaxed);
+    return result;
+}
+
+static std::string describe_callback(const std::string& profile_key)
+{
+    unsigned token = Interpreter::callback_token(profile_key);
+    if (token == 0 || !t_interp)
+        return std::string();
+    return t_interp->describe_callback(token);
+}
+
+void set_callback_profiling(bool enabled)
+{
+    g_callback_profiling.store(enabled, std::memory_order_relaxed);
+}
+
+std::vector<CallbackStats> callback_stats()
+{
+    std::vector<CallbackStats> result;
+    result.reserve(t_callback_profile.size());
+    for (const auto& kv : t_callback_profile)
+        result.push_back(kv.second);
+    std::sort(result.begin(), result.end(), [](const CallbackStats& a, const CallbackStats& b) {
+        return a.total_time > b.total_time;
+    });
+    return result;
+}
+
+void reset_callback_stats()
+{
+    t_callback_profile.clear();
+}
+
+// set_callback_stats_dump()の呼び出しスレッドごとの状態。Tclのタイマはスレッドごとの
+// イベントループに属するため、こちらもスレッドごとに持つ。
+struct CallbackStatsDump
+{
+    Tcl_TimerToken                                        timer = nullptr;
+    int                                                   interval_ms = 0;
+    std::function<void(const std::vector<CallbackStats>&)> sink;
+};
+
+static thread_local CallbackStatsDump t_callback_stats_dump;
+
+static void print_callback_stats(const std::vector<CallbackStats>& stats)
+{
+    std::cerr << "cpp_tk callback stats (" << stats.size() << " callbacks):\n";
+    for (const auto& entry : stats)
+    {
+        std::cerr << "  " << entry.name;
+        if (!entry.description.empty())
+            std::cerr << " [" << entry.description << "]";
+        std::cerr << " calls=" << entry.calls
+                  << " total=" << std::chrono::duration_cast<std::chrono::microseconds>(entry.total_time).count() << "us"
+                  << " max=" << std::chrono::duration_cast<std::chrono::microseconds>(entry.max_time).count() << "us\n";
+    }
+}
+
+static void dump_callback_stats(ClientData /*client_data*/)
+{
+    auto& dump = t_callback_stats_dump;
+    dump.timer = Tcl_CreateTimerHandler(dump.interval_ms, &dump_callback_stats, nullptr);
+    auto stats = callback_stats();
+    invoke_guarded([&]() {
+        if (dump.sink)
+            dump.sink(stats);
+        else
+            print_callback_stats(stats);
+    });
+}
+
+void set_callback_stats_dump(std::chrono::milliseconds interval, std::function<void(const std::vector<CallbackStats>&)> sink)
+{
+    current_interp();
+    auto& dump = t_callback_stats_dump;
+    if (dump.timer)
+    {
+        Tcl_DeleteTimerHandler(dump.timer);
+        dump.timer = nullptr;
+    }
+    dump.interval_ms = (int)interval.count();
+    dump.sink        = std::move(sink);
+    if (dump.interval_ms > 0)
+        dump.timer = Tcl_CreateTimerHandler(dump.interval_ms, &dump_callback_stats, nullptr);
+}
+
+bool create_tcl_only_interpreter()
+{
+    if (t_interp)
+        return false;
+    register_interp(new Interpreter(false));
+    return true;
+}
+
+// current_interp()と異なり、Interpreterが無ければ生成せずnullptrを返す(Tkの構築を前提とする
+// ダイアログ系の関数用)。
+static Interpreter* existing_interp()
+{
+    return t_interp;
+}
+
+std::vector<std::thread::id> interpreter_threads()
+{
+    std::lock_guard<std::mutex> lock(g_interp_registry_mutex);
+    std::vector<std::thread::id> threads;
+    threads.reserve(g_interp_registry.size());
+    for (const auto& kv : g_interp_registry)
+        threads.push_back(kv.first);
+    return threads;
+}
+
+ArgValue::ArgValue() noexcept
+    : type_(ValueType::NONE)
+    , i_(0)
+{}
+
+ArgValue::ArgValue(const std::string& s)
+    : type_(ValueType::STRING)
+{
+    new (&str_) std::string(s);
+}
+
+ArgValue::ArgValue(std::string&& s) noexcept
+    : type_(ValueType::STRING)
+{
+    new (&str_) std::string(std::move(s));
+}
+
+ArgValue::ArgValue(const char* s)
+    : type_(ValueType::STRING)
+{
+    new (&str_) std::string(s);
+}
+
+ArgValue::ArgValue(int v)
+    : type_(ValueType::INT)
+    , i_(v)
+{}
+
+ArgValue::ArgValue(double v)
+    : type_(ValueType::DOUBLE)
+    , d_(v)
+{}
+
+ArgValue::ArgValue(bool v)
+    : type_(ValueType::BOOL)
+    , b_(v)
+{}
+
+ArgValue::ArgValue(const std::vector<uint8_t>& bytes)
+    : type_(ValueType::BYTES)
+{
+    new (&bytes_) std::vector<uint8_t>(bytes);
+}
+
+ArgValue::ArgValue(const std::vector<ArgValue>& list)
+    : type_(ValueType::LIST)
+    , list_(new std::vector<ArgValue>(list))
+{}
+
+ArgValue::ArgValue(const std::map<std::string, ArgValue>& dict)
+    : type_(ValueType::DICT)
+    , dict_(new std::map<std::string, ArgValue>(dict))
+{}
+
+ArgValue::ArgValue(Var& var)
+    : ArgValue(var.name())
+{}
+
+ArgValue::ArgValue(const StringRef& ref) noexcept
+    : type_(ValueType::STRING_REF)
+    , ref_(ref)
+{}
+
+ArgValue::ArgValue(const IntArrayRef& ints) noexcept
+    : type_(ValueType::INT_ARRAY)
+    , ints_(ints)
+{}
+
+ArgValue::ArgValue(const DoubleArrayRef& doubles) noexcept
+    : type_(ValueType::DOUBLE_ARRAY)
+    , doubles_(doubles)
+{}
+
+ArgValue::ArgValue(const TclValue& value)
+    : type_(value.empty() ? ValueType::NONE : ValueType::OBJ)
+    , obj_(value.obj())
+{
+    if (obj_)
+        Tcl_IncrRefCount(obj_);
+}
+
+ArgValue::ArgValue(const ArgValue& other)
+    : type_(ValueType::NONE)
+{
+    copy_from(other);
+}
+
+ArgValue::ArgValue(ArgValue&& other) noexcept
+    : type_(ValueType::NONE)
+{
+    move_from(other);
+}
+
+ArgValue& ArgValue::operator=(const ArgValue& other)
+{
+    // otherが自分自身の要素(LIST/DICTの中身)である場合に備え、先に複製してから入れ替える。
+    if (this != &other)
+    {
+        ArgValue tmp(other);
+        cleanup();
+        move_from(tmp);
+    }
+    return *this;
+}
+
+ArgValue& ArgValue::operator=(ArgValue&& other) noexcept
+{
+    if (this != &other)
+    {
+        cleanup();
+        move_from(other);
+    }
+    return *this;
+}
+
+ArgValue::~ArgValue()
+{
+    cleanup();
+}
+
+ArgValue::ValueType ArgValue::type() const
+{
+    return type_;
+}
+
+void ArgValue::cleanup() noexcept
+{
+    switch (type_)
+    {
+        case ValueType::STRING:
+            str_.~basic_string();
+            break;
+        case ValueType::BYTES:
+            bytes_.~vector();
+            break;
+        case ValueType::LIST:
+            delete list_;
+            break;
+        case ValueType::DICT:
+            delete dict_;
+            break;
+        case ValueType::OBJ:
+            Tcl_DecrRefCount(obj_);
+            break;
+        default:
+            break;
+    }
+    type_ = ValueType::NONE;
+}
+
+// thisはNONE(何も構築されていない状態)であること。
+void ArgValue::copy_from(const ArgValue& other)
+{
+    switch (other.type_)
+    {
+        case ValueType::STRING:
+            new (&str_) std::string(other.str_);
+            break;
+        case ValueType::INT:
+            i_ = other.i_;
+            break;
+        case ValueType::DOUBLE:
+            d_ = other.d_;
+            break;
+        case ValueType::BOOL:
+            b_ = other.b_;
+            break;
+        case ValueType::BYTES:
+            new (&bytes_) std::vector<uint8_t>(other.bytes_);
+            break;
+        case ValueType::LIST:
+            list_ = new std::vector<ArgValue>(*other.list_);
+            break;
+        case ValueType::DICT:
+            dict_ = new std::map<std::string, ArgValue>(*other.dict_);
+            break;
+        case ValueType::OBJ:
+            obj_ = other.obj_;
+            Tcl_IncrRefCount(obj_);
+            break;
+        case ValueType::STRING_REF:
+            ref_ = other.ref_;
+            break;
+        case ValueType::INT_ARRAY:
+            ints_ = other.ints_;
+            break;
+        case ValueType::DOUBLE_ARRAY:
+            doubles_ = other.doubles_;
+            break;
+        default:
+            break;
+    }
+    type_ = other.type_;
+}
+
+// thisはNONEであること。otherの中身を奪い、otherはNONEに戻す。
+void ArgValue::move_from(ArgValue& other) noexcept
+{
+    switch (other.type_)
+    {
+        case ValueType::STRING:
+            new (&str_) std::string(std::move(other.str_));
+            break;
+        case ValueType::INT:
+            i_ = other.i_;
+            break;
+        case ValueType::DOUBLE:
+            d_ = other.d_;
+            break;
+        case ValueType::BOOL:
+            b_ = other.b_;
+            break;
+        case ValueType::BYTES:
+            new (&bytes_) std::vector<uint8_t>(std::move(other.bytes_));
+            break;
+        case ValueType::LIST:
+            list_ = other.list_;
+            other.list_ = nullptr;
+            break;
+        case ValueType::DICT:
+            dict_ = other.dict_;
+            other.dict_ = nullptr;
+            break;
+        case ValueType::OBJ:
+            obj_ = other.obj_;
+            other.type_ = ValueType::NONE;
+            type_ = ValueType::OBJ;
+            return;
+        case ValueType::STRING_REF:
+            ref_ = other.ref_;
+            break;
+        case ValueType::INT_ARRAY:
+            ints_ = other.ints_;
+            break;
+        case ValueType::DOUBLE_ARRAY:
+            doubles_ = other.doubles_;
+            break;
+        default:
+            break;
+    }
+    type_ = other.type_;
+    other.cleanup();
+}
+
+TclValue::TclValue() noexcept
+    : obj_(nullptr)
+{}
+
+// Tcl_Objの確保にはTclのサブシステムが初期化済みである必要がある。呼び出しスレッドにInterpreterがあれば
+// 初期化済みなのでそのまま使い、無ければTclのライブラリだけを初期化する(Interpreterを作るとTk_Initまで
+// 走り、ディスプレイの無い環境やTclのみで使うスレッドで失敗するため)。
+static void ensure_tcl_subsystems()
+{
+    if (t_interp)
+        return;
+    static std::once_flag initialized;
+    std::call_once(initialized, []() { Tcl_FindExecutable(nullptr); });
+}
+
+TclValue::TclValue(const ArgValue& value)
+    : obj_(nullptr)
+{
+    ensure_tcl_subsystems();
+    obj_ = make_obj(nullptr, value);
+    Tcl_IncrRefCount(obj_);
+}
+
+TclValue::TclValue(const TclValue& other)
+    : obj_(other.obj_)
+{
+    if (obj_)
+        Tcl_IncrRefCount(obj_);
+}
+
+TclValue::TclValue(TclValue&& other) noexcept
+    : obj_(other.obj_)
+{
+    other.obj_ = nullptr;
+}
+
+TclValue& TclValue::operator=(const TclValue& other)
+{
+    if (other.obj_)
+        Tcl_IncrRefCount(other.obj_);
+    if (obj_)
+        Tcl_DecrRefCount(obj_);
+    obj_ = other.obj_;
+    return *this;
+}
+
+TclValue& TclValue::operator=(TclValue&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (obj_)
+            Tcl_DecrRefCount(obj_);
+        obj_ = other.obj_;
+        other.obj_ = nullptr;
+    }
+    return *this;
+}
+
+TclValue::~TclValue()
+{
+    if (obj_)
+        Tcl_DecrRefCount(obj_);
+}
+
+std::string TclValue::str() const
+{
+    if (!obj_)
+        return {};
+    int len = 0;
+    const char* bytes = Tcl_GetStringFromObj(obj_, &len);
+    return std::string(bytes, len);
+}
+
+TclValue TclValue::adopt(Tcl_Obj* obj)
+{
+    TclValue value;
+    value.obj_ = obj;
+    if (obj)
+        Tcl_IncrRefCount(obj);
+    return value;
+}
+
+ArgValue list(std::initializer_list<ArgValue> items)
+{
+    return ArgValue(std::vector<ArgValue>(items));
+}
+
+ArgValue dict(std::initializer_list<std::pair<const std::string, ArgValue>> items)
+{
+    return ArgValue(std::map<std::string, ArgValue>(items));
+}
+
+Options::Options(const std::map<std::string, ArgValue>& options)
+{
+    words_.reserve(options.size() * 2);
+    for (const auto& kv : options)
+    {
+        words_.push_back("-" + kv.first);
+        words_.push_back(kv.second);
+    }
+}
+
+// 従来のmap引数と同じ並び(キー順)・同じ重複の扱い(先勝ち)にするため、一度mapを経由する。
+Options::Options(std::initializer_list<std::pair<const std::string, ArgValue>> options)
+    : Options(std::map<std::string, ArgValue>(options))
+{}
+
+Options& Options::set(const std::string& name, ArgValue value)
+{
+    return add("-" + name, std::move(value));
+}
+
+Options& Options::add(ArgValue&& name, ArgValue&& value)
+{
+    words_.push_back(std::move(name));
+    words_.push_back(std::move(value));
+    return *this;
+}
+
+void Options::append_to(std::vector<ArgValue>& words) const
+{
+    words.insert(words.end(), words_.begin(), words_.end());
+}
+
+Object::Object()
+    : id(next())
+{}
+
+std::string Object::next()
+{
+    // Var/PhotoImage/Font等は各GUIスレッドで並行して構築されるため、IDの採番はatomicにする。
+    static std::atomic<int> count{0};
+    return std::to_string(count.fetch_add(1, std::memory_order_relaxed));
+}
+
+Interpreter* InterpreterClient::checked_interp(const char* operation, bool* success) const
+{
+    auto* p = interp();
+    if (p == nullptr)
+    {
+        report_or_throw(operation, success, ErrorPolicy::LENIENT_CALL, ErrorRecord::Kind::UNINITIALIZED, type_name());
+        return nullptr;
+    }
+
+    // 所有スレッドの終了でTcl_Interpが破棄済み(Interpreter::retire())。
+    if (!p->alive())
+    {
+        report_or_throw(operation, success, ErrorPolicy::LENIENT_THREAD, ErrorRecord::Kind::THREAD_EXITED, type_name());
+        return nullptr;
+    }
+
+    // Tcl_Interpは生成したスレッド以外から触ると内部状態を破壊しうる未定義動作になりうるが、
+    // この検知自体はTcl_Interpに一切触れる前に働くため、Error送出/ログのみ継続のどちらを
+    // 選んでも「危険なTcl呼び出しをしない」という安全性は同じ(呼び出し元への通知方法が
+    // 違うだけ)。そのためLENIENT_THREADで他のカテゴリと同様に緩められるようにする。
+    if (p->owner_thread() != std::this_thread::get_id())
+    {
+        report_or_throw(operation, success, ErrorPolicy::LENIENT_THREAD, ErrorRecord::Kind::WRONG_THREAD, type_name());
+        return nullptr;
+    }
+
+    return p;
+}
+
+std::string InterpreterClient::call(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = checked_interp("call", success);
+    if (p == nullptr)
+        return {};
+
+    bool ok = false;
+    auto result = p->call(words, &ok, path_obj());
+    if (!ok)
+    {
+        report_tcl_failure(*p, "call", success);
+        return result;
+    }
+    if (success) *success = true;
+    return result;
+}
+
+Interpreter* InterpreterClient::eval_checked(const char* operation, const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = checked_interp(operation, success);
+    if (p == nullptr)
+        return nullptr;
+
+    if (!p->eval(words, path_obj()))
+    {
+        report_tcl_failure(*p, operation, success);
+        return nullptr;
+    }
+    if (success) *success = true;
+    return p;
+}
+
+bool InterpreterClient::exec(const std::vector<ArgValue>& words, bool* success) const
+{
+    // 呼び出しスレッドのInterpreter(t_interp)でバッチ中なら、所有スレッドの一致は自明なので
+    // checked_interp()の検査を省いて溜めるだけにする。
+    auto* p = interp();
+    if (p == nullptr || p != t_interp || !p->batching())
+        p = checked_interp("exec", success);
+    if (p == nullptr)
+        return false;
+
+    if (!p->exec(words, path_obj()))
+    {
+        report_tcl_failure(*p, "exec", success);
+        return false;
+    }
+    if (success) *success = true;
+    return true;
+}
+
+bool InterpreterClient::exec_now(const std::vector<ArgValue>& words, bool* success) const
+{
+    return eval_checked("exec_now", words, success) != nullptr;
+}
+
+int InterpreterClient::call_int(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_int", words, success);
+    return p ? p->result_int() : 0;
+}
+
+double InterpreterClient::call_double(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_double", words, success);
+    return p ? p->result_double() : 0.0;
+}
 
-    std::unordered_map<std::string, std::function<void()>>                      void_callback_map_;
+bool InterpreterClient::call_bool(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_bool", words, success);
+    return p ? p->result_bool() : false;
+}
 
-    std::unordered_map<std::string, std::function<void(const int&)>>            int_callback_map_;
+std::vector<std::string> InterpreterClient::call_list(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_list", words, success);
+    return p ? p->result_list() : std::vector<std::string>();
+}
 
-    std::unordered_map<std::string, std::function<void(const double&)>>         double_callback_map_;
+std::vector<int> InterpreterClient::call_int_list(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_int_list", words, success);
+    return p ? p->result_int_list() : std::vector<int>();
+}
 
-    std::unordered_map<std::string, std::function<bool(const std::string&)>>    bool_callback_map_;
+TclValue InterpreterClient::call_value(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = eval_checked("call_value", words, success);
+    return p ? TclValue::adopt(p->result_obj()) : TclValue();
+}
 
-    std::unordered_map<std::string, std::function<void(const std::string&)>>    string_callback_map_;
-};
+void InterpreterClient::post(std::function<void()> job) const
+{
+    // checked_interp()は意図的に通さない(スレッド一致チェックはpost()の用途と矛盾するため)。
+    // 未初期化オブジェクトへの呼び出しはこれまで通りerror_policy()に従う(この時点ではまだ
+    // Tcl_Interpに一切触れていないため、クロススレッドの危険はない)。
+    auto* p = interp();
+    if (p == nullptr)
+    {
+        report_or_throw("post", nullptr, ErrorPolicy::LENIENT_CALL, ErrorRecord::Kind::UNINITIALIZED, type_name());
+        return;
+    }
+    if (!p->post(std::move(job)))
+    {
+        report_or_throw("post", nullptr, ErrorPolicy::LENIENT_THREAD, ErrorRecord::Kind::THREAD_EXITED, type_name());
+    }
+}
 
-// Interpreterはスレッドごとにちょうど1つだけ存在する遅延生成のシングルトン。
-// 呼び出しスレッドに紐づくInterpreterが無ければこの場で生成して登録するため、
-// current_interp()は常に有効なポインタを返す(nullptrにはならない)。tk::Tkの構築を
-// 待たずにVar/PhotoImage/font::Font/ttk::Styleを構築しても、その場でInterpreterが
-// 用意される。同一スレッドでtk::Tkを複数回構築しても、この関数が返す既存の
-// Interpreterを再利用するだけなので上書き・迷子になったInterpreterは発生しない。
-Interpreter* current_interp()
+Batch::Batch()
+    : interp_(current_interp())
 {
-    Interpreter*& interp = interp_map[std::this_thread::get_id()];
-    if (!interp)
-        interp = new Interpreter();
-    return interp;
+    interp_->begin_batch();
 }
 
-ArgValue::ArgValue()
-    : type_(ValueType::NONE)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
-{}
+Batch::~Batch()
+{
+    // デストラクタからは例外を送出できないため、失敗はログのみとする(クラスコメント参照)。
+    bool ok = false;
+    try { interp_->end_batch(&ok); } catch (...) {}
+}
 
-ArgValue::ArgValue(const std::string& s)
-    : type_(ValueType::STRING)
-    , str_(new std::string(s))
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
-{}
+void Batch::flush(bool* success)
+{
+    interp_->flush_batch(success);
+}
 
-ArgValue::ArgValue(const char* s)
-    : type_(ValueType::STRING)
-    , str_(new std::string(s))
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
+Timer::Timer()
 {}
 
-ArgValue::ArgValue(int v)
-    : type_(ValueType::INT)
-    , i_(v)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
+Timer::Timer(std::shared_ptr<TimerState> state)
+    : state_(std::move(state))
 {}
 
-ArgValue::ArgValue(double v)
-    : type_(ValueType::DOUBLE)
-    , d_(v)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
+Timer::Timer(Timer&& other) noexcept
+    : state_(std::move(other.state_))
 {}
 
-ArgValue::ArgValue(bool v)
-    : type_(ValueType::BOOL)
-    , b_(v)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
-{}
+Timer& Timer::operator=(Timer&& other) noexcept
+{
+    if (this != &other)
+    {
+        cancel();
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
 
-ArgValue::ArgValue(const std::vector<uint8_t>& bytes)
-    : type_(ValueType::BYTES)
-    , str_(nullptr)
-    , bytes_(new std::vector<uint8_t>(bytes))
-    , list_(nullptr)
-    , dict_(nullptr)
-{}
+Timer::~Timer()
+{
+    cancel();
+}
 
-ArgValue::ArgValue(const std::vector<ArgValue>& list)
-    : type_(ValueType::LIST)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(new std::vector<ArgValue>(list))
-    , dict_(nullptr)
-{}
+Timer Timer::once(int ms, std::function<void()> callback)
+{
+    if (!callback)
+        return Timer();
+    return Timer(current_interp()->start_timer(std::max(ms, 0), false, std::move(callback)));
+}
 
-ArgValue::ArgValue(const std::map<std::string, ArgValue>& dict)
-    : type_(ValueType::DICT)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(new std::map<std::string, ArgValue>(dict))
-{}
+Timer Timer::every(int ms, std::function<void()> callback)
+{
+    if (!callback)
+        return Timer();
+    // 0msの周期はイベントループを占有してしまうため、1ms以上にする。
+    return Timer(current_interp()->start_timer(std::max(ms, 1), true, std::move(callback)));
+}
 
-ArgValue::ArgValue(Var& var)
-    : ArgValue(var.name())
-{}
+void Timer::cancel()
+{
+    // Interpreterの破棄後はactiveがfalseになっているため、state_->interpには触れない。
+    if (state_ && state_->active)
+        state_->interp->cancel_timer(state_.get());
+}
 
-ArgValue::ArgValue(const ArgValue& other)
-    : type_(ValueType::NONE)
-    , str_(nullptr)
-    , bytes_(nullptr)
-    , list_(nullptr)
-    , dict_(nullptr)
+void Timer::detach()
 {
-    copy_from(other);
+    state_.reset();
 }
 
-ArgValue& ArgValue::operator=(const ArgValue& other)
+bool Timer::active() const
 {
-    if (this != &other)
-    {
-        cleanup();
-        copy_from(other);
-    }
-    return *this;
+    return state_ && state_->active;
 }
 
-ArgValue::~ArgValue()
+bool schedule_idle(const std::string& key, std::function<void()> callback)
 {
-    cleanup();
+    if (!callback)
+        return false;
+    return current_interp()->schedule_idle(key, std::move(callback));
 }
 
-ArgValue::ValueType ArgValue::type() const
+bool cancel_idle(const std::string& key)
 {
-    return type_;
+    return current_interp()->cancel_idle(key);
 }
 
-void ArgValue::cleanup()
+// タイマのコールバックはImplをweak_ptrで参照し、フレームの処理中だけ生存を延ばす(更新処理の中で
+// Animatorが破棄されても、そのフレームの終わりまではImplが残る)。
+struct Animator::Impl
 {
-    if (type_ == ValueType::STRING && str_)
-    {
-        delete str_;
-        str_ = nullptr;
-    }
-    else if (type_ == ValueType::BYTES && bytes_)
+    static constexpr std::size_t recent_capacity = 1024;
+
+    std::chrono::nanoseconds                                           period;
+    std::vector<std::pair<std::size_t, std::function<void(double)>>>   updates;   // 解除されたものは空にして、フレームの後で詰める
+    std::size_t                                                        last_id = 0;
+    std::size_t                                                        serial = next_serial();  // 計測結果のキー("animator <serial>/<id>")
+    bool                                                               in_frame = false;
+    bool                                                               closed = false;
+    Timer                                                              timer;
+    std::chrono::steady_clock::time_point                              due;
+    std::chrono::steady_clock::time_point                              last_frame;
+    bool                                                               first_frame = true;
+
+    std::size_t                                                        frames = 0;
+    std::size_t                                                        dropped = 0;
+    std::chrono::nanoseconds                                           total{0};
+    std::chrono::nanoseconds                                           min{0};
+    std::chrono::nanoseconds                                           max{0};
+    std::vector<std::chrono::nanoseconds>                              recent;    // 直近のフレーム時間(リングバッファ)
+    std::size_t                                                        recent_next = 0;
+
+    ~Impl()
     {
-        delete bytes_;
-        bytes_ = nullptr;
+        for (const auto& update : updates)
+            release_stats(update.first);
     }
-    else if (type_ == ValueType::LIST && list_)
+
+    static std::size_t next_serial()
     {
-        delete list_;
-        list_ = nullptr;
+        static std::atomic<std::size_t> count{0};
+        return count.fetch_add(1, std::memory_order_relaxed) + 1;
     }
-    else if (type_ == ValueType::DICT && dict_)
+
+    std::string profile_key(std::size_t id) const
     {
-        delete dict_;
-        dict_ = nullptr;
+        return "animator " + std::to_string(serial) + "/" + std::to_string(id);
     }
-    type_ = ValueType::NONE;
-}
-
-void ArgValue::copy_from(const ArgValue& other)
-{
-    type_ = other.type_;
-    str_  = nullptr;
-    bytes_ = nullptr;
-    list_  = nullptr;
-    dict_  = nullptr;
 
-    if (other.type_ == ValueType::STRING)
+    // 解除した更新処理の計測結果を"animator"に合算する。
+    void release_stats(std::size_t id) const
     {
-        str_ = new std::string(*other.str_);
+        if (!t_callback_profile.empty())
+            fold_callback_stats(profile_key(id), "animator");
     }
-    else if (other.type_ == ValueType::INT)
+
+    static std::chrono::nanoseconds period_of(double fps)
     {
-        i_ = other.i_;
+        return std::chrono::nanoseconds((long long)(1e9 / fps));
     }
-    else if (other.type_ == ValueType::DOUBLE)
+
+    // dueに次のフレームを予約する。Timerはミリ秒単位のため、早く呼ばれないよう切り上げる。
+    static void schedule(const std::shared_ptr<Impl>& self)
     {
-        d_ = other.d_;
+        auto wait = self->due - std::chrono::steady_clock::now();
+        long long ms = 0;
+        if (wait > std::chrono::nanoseconds::zero())
+            ms = (std::chrono::duration_cast<std::chrono::microseconds>(wait).count() + 999) / 1000;
+        std::weak_ptr<Impl> weak = self;
+        self->timer = Timer::once((int)ms, [weak]() {
+            if (auto impl = weak.lock())
+                run_frame(impl);
+        });
     }
-    else if (other.type_ == ValueType::BOOL)
+
+    static void run_frame(const std::shared_ptr<Impl>& self)
     {
-        b_ = other.b_;
+        const auto now = std::chrono::steady_clock::now();
+        // 1周期以上遅れていれば、その間のフレームは続けて処理せずに飛ばす。
+        if (now - self->due >= self->period)
+        {
+            auto missed = (now - self->due) / self->period;
+            self->dropped += (std::size_t)missed;
+            self->due += missed * self->period;
+        }
+        self->due += self->period;
+        schedule(self);
+
+        const double dt = self->first_frame
+            ? std::chrono::duration<double>(self->period).count()
+            : std::chrono::duration<double>(now - self->last_frame).count();
+        self->first_frame = false;
+        self->last_frame  = now;
+
+        self->in_frame = true;
+        {
+            Batch batch;
+            const std::size_t count = self->updates.size();
+            for (std::size_t i = 0; i < count && !self->closed; ++i)
+            {
+                if (!self->updates[i].second)
+                    continue;
+                if (g_callback_profiling.load(std::memory_order_relaxed))
+                    invoke_guarded([&]() { self->updates[i].second(dt); }, self->profile_key(self->updates[i].first).c_str());
+                else
+                    invoke_guarded([&]() { self->updates[i].second(dt); });
+            }
+        }
+        self->in_frame = false;
+        Impl* impl = self.get();
+        self->updates.erase(std::remove_if(self->updates.begin(), self->updates.end(),
+                                           [impl](const std::pair<std::size_t, std::function<void(double)>>& u) {
+                                               if (u.second)
+                                                   return false;
+                                               impl->release_stats(u.first);
+                                               return true;
+                                           }),
+                            self->updates.end());
+
+        record(self.get(), std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now));
     }
-    else if (other.type_ == ValueType::BYTES)
+
+    static void record(Impl* self, std::chrono::nanoseconds frame_time)
     {
-        bytes_ = new std::vector<uint8_t>(*other.bytes_);
+        if (self->frames == 0 || frame_time < self->min)
+            self->min = frame_time;
+        if (frame_time > self->max)
+            self->max = frame_time;
+        ++self->frames;
+        self->total += frame_time;
+        if (self->recent.size() < recent_capacity)
+            self->recent.push_back(frame_time);
+        else
+            self->recent[self->recent_next] = frame_time;
+        self->recent_next = (self->recent_next + 1) % recent_capacity;
     }
-    else if (other.type_ == ValueType::LIST)
+};
+
+Animator::Animator(double fps)
+    : impl_(std::make_shared<Impl>())
+{
+    impl_->period = Impl::period_of(fps > 0.0 ? fps : 60.0);
+}
+
+Animator::Animator(Animator&& other) noexcept
+    : impl_(std::move(other.impl_))
+{}
+
+Animator& Animator::operator=(Animator&& other) noexcept
+{
+    if (this != &other)
     {
-        list_ = new std::vector<ArgValue>(*other.list_);
+        stop();
+        impl_ = std::move(other.impl_);
     }
-    else if (other.type_ == ValueType::DICT)
+    return *this;
+}
+
+Animator::~Animator()
+{
+    if (!impl_)
+        return;
+    impl_->closed = true;
+    stop();
+}
+
+std::size_t Animator::add(std::function<void(double)> update)
+{
+    impl_->updates.emplace_back(++impl_->last_id, std::move(update));
+    return impl_->last_id;
+}
+
+void Animator::remove(std::size_t id)
+{
+    auto& updates = impl_->updates;
+    for (auto it = updates.begin(); it != updates.end(); ++it)
     {
-        dict_ = new std::map<std::string, ArgValue>(*other.dict_);
+        if (it->first != id)
+            continue;
+        // フレームの処理中は添字がずれないよう空にするだけにし、フレームの後で詰める。
+        if (impl_->in_frame)
+        {
+            it->second = nullptr;
+        }
+        else
+        {
+            impl_->release_stats(id);
+            updates.erase(it);
+        }
+        return;
     }
 }
 
-ArgValue list(std::initializer_list<ArgValue> items)
+void Animator::start()
 {
-    return ArgValue(std::vector<ArgValue>(items));
+    if (running())
+        return;
+    impl_->due         = std::chrono::steady_clock::now() + impl_->period;
+    impl_->first_frame = true;
+    Impl::schedule(impl_);
 }
 
-ArgValue dict(std::initializer_list<std::pair<const std::string, ArgValue>> items)
+void Animator::stop()
 {
-    return ArgValue(std::map<std::string, ArgValue>(items));
+    if (impl_)
+        impl_->timer.cancel();
 }
 
-Object::Object()
-    : id(next())
-{}
+bool Animator::running() const
+{
+    return impl_ && impl_->timer.active();
+}
 
-std::string Object::next()
+void Animator::set_fps(double fps)
 {
-    static int count = 0;
-    return std::to_string(count++);
+    if (fps > 0.0)
+        impl_->period = Impl::period_of(fps);
 }
 
-Interpreter* InterpreterClient::checked_interp(const char* operation, bool* success) const
+double Animator::fps() const
 {
-    auto* p = interp();
-    if (p == nullptr)
-    {
-        report_or_throw(std::string(operation) + "() called on an uninitialized " + type_name() + " (interp == nullptr).", success, ErrorPolicy::LENIENT_CALL);
-        return nullptr;
-    }
+    return 1e9 / (double)impl_->period.count();
+}
 
-    // Tcl_Interpは生成したスレッド以外から触ると内部状態を破壊しうる未定義動作になりうるが、
-    // この検知自体はTcl_Interpに一切触れる前に働くため、Error送出/ログのみ継続のどちらを
-    // 選んでも「危険なTcl呼び出しをしない」という安全性は同じ(呼び出し元への通知方法が
-    // 違うだけ)。そのためLENIENT_THREADで他のカテゴリと同様に緩められるようにする。
-    if (p->owner_thread() != std::this_thread::get_id())
+FrameStats Animator::stats() const
+{
+    FrameStats result = FrameStats();
+    result.frames         = impl_->frames;
+    result.dropped_frames = impl_->dropped;
+    result.min_frame_time = impl_->min;
+    result.max_frame_time = impl_->max;
+    if (impl_->frames > 0)
+        result.avg_frame_time = impl_->total / (long long)impl_->frames;
+    if (!impl_->recent.empty())
     {
-        report_or_throw(std::string(operation) + "() called on a " + type_name()
-            + " from a thread different than the one that owns its Tcl interpreter. "
-              "Tcl_Interp must only be accessed from the thread that created it.", success, ErrorPolicy::LENIENT_THREAD);
-        return nullptr;
+        auto recent = impl_->recent;
+        auto nth = recent.begin() + (std::ptrdiff_t)((recent.size() - 1) * 99 / 100);
+        std::nth_element(recent.begin(), nth, recent.end());
+        result.p99_frame_time = *nth;
     }
+    return result;
+}
 
-    return p;
+void Animator::reset_stats()
+{
+    impl_->frames      = 0;
+    impl_->dropped     = 0;
+    impl_->total       = std::chrono::nanoseconds::zero();
+    impl_->min         = std::chrono::nanoseconds::zero();
+    impl_->max         = std::chrono::nanoseconds::zero();
+    impl_->recent.clear();
+    impl_->recent_next = 0;
 }
 
-std::string InterpreterClient::call(const std::vector<ArgValue>& words, bool* success) const
+Script::Script(const std::string& body, const std::vector<std::string>& params)
+    : interp_(current_interp())
+    , script_(params.empty() ? ArgValue(body) : list({std::vector<ArgValue>(params.begin(), params.end()), body}))
+    , is_lambda_(!params.empty())
+{}
+
+std::string Script::run(const std::vector<ArgValue>& args, bool* success) const
 {
-    auto* p = checked_interp("call", success);
+    if (is_lambda_)
+    {
+        // "apply"に同じラムダのTcl_Objを渡し続けることで、ラムダのコンパイル結果も使い回される。
+        std::vector<ArgValue> words = {"apply", script_};
+        words.insert(words.end(), args.begin(), args.end());
+        return call(words, success);
+    }
+
+    auto* p = checked_interp("run", success);
     if (p == nullptr)
         return {};
 
-    bool ok = false;
-    auto result = p->call(words, &ok);
-    if (!ok)
+    if (!args.empty())
     {
-        report_or_throw("call() failed to execute Tcl command: " + result, success, ErrorPolicy::LENIENT_CALL);
+        report_or_throw("run", success, ErrorPolicy::LENIENT_CALL, ErrorRecord::Kind::UNEXPECTED_ARGUMENTS, type_name());
+        return {};
+    }
+    if (!p->eval_script(script_.obj()))
+    {
+        auto result = p->result_string();
+        report_tcl_failure(*p, "run", success);
         return result;
     }
     if (success) *success = true;
-    return result;
+    return p->result_string();
 }
 
-void InterpreterClient::post(std::function<void()> job) const
+struct Var::TraceState
 {
-    // checked_interp()は意図的に通さない(スレッド一致チェックはpost()の用途と矛盾するため)。
-    // 未初期化オブジェクトへの呼び出しはこれまで通りerror_policy()に従う(この時点ではまだ
-    // Tcl_Interpに一切触れていないため、クロススレッドの危険はない)。
-    auto* p = interp();
-    if (p == nullptr)
+    Interpreter* interp = nullptr;  // trace()でトレースを張ったInterpreter(張っていなければnullptr)
+    std::string  name;
+
+    ~TraceState()
     {
-        report_or_throw(std::string("post() called on an uninitialized ") + type_name() + " (interp == nullptr).", nullptr, ErrorPolicy::LENIENT_CALL);
-        return;
+        if (interp)
+            interp->release_var_traces(name);
     }
-    p->post(std::move(job));
-}
+};
 
 Var::Var()
     : interp_(nullptr)
+    , trace_state_(std::make_shared<TraceState>())
 {}
 
 const std::string& Var::name() const
@@ -754,22 +3336,39 @@ void Var::set_var(const std::string& value)
     if (p) p->set_var(name_, value);
 }
 
+void Var::remember_trace(Interpreter* p)
+{
+    if (!trace_state_)
+        trace_state_ = std::make_shared<TraceState>();
+    trace_state_->interp = p;
+    trace_state_->name   = name_;
+}
+
 void Var::trace_var(std::function<void(const std::string&)> callback)
 {
     auto* p = checked_interp("trace");
-    if (p) p->trace_var(name_, callback);
+    if (!p)
+        return;
+    p->trace_var(name_, callback);
+    remember_trace(p);
 }
 
 void Var::trace_var(std::function<void(const int&)> callback)
 {
     auto* p = checked_interp("trace");
-    if (p) p->trace_var(name_, callback);
+    if (!p)
+        return;
+    p->trace_var(name_, callback);
+    remember_trace(p);
 }
 
 void Var::trace_var(std::function<void(const double&)> callback)
 {
     auto* p = checked_interp("trace");
-    if (p) p->trace_var(name_, callback);
+    if (!p)
+        return;
+    p->trace_var(name_, callback);
+    remember_trace(p);
 }
 
 StringVar::StringVar()
@@ -865,19 +3464,15 @@ void DoubleVar::trace(std::function<void(const double&)> callback)
 Widget::Widget()
 {}
 
-Widget::Widget(const Widget& parent, const std::string &type, const std::string& name, const std::map<std::string, ArgValue>& options)
+Widget::Widget(const Widget& parent, const std::string &type, const std::string& name, const Options& options)
 {
     impl_->interp = parent.impl_->interp;
     auto parent_name = (parent.full_name() == ".") ? "" : parent.full_name();
     impl_->full_name = parent_name + "." + (name.empty() ? type : name) + id;
 
     std::vector<ArgValue> words = {type, impl_->full_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec_now(words);
 }
 
 const std::string& Widget::full_name() const
@@ -885,91 +3480,133 @@ const std::string& Widget::full_name() const
     return impl_->full_name;
 }
 
-void Widget::register_void_callback(const std::string& name, std::function<void()> callback) const
+Widget::Impl::~Impl()
+{
+    if (!path_obj && !command_cache)
+        return;
+    if (interp)
+    {
+        interp->release_widget_objects(command_cache, path_obj, full_name);
+        return;
+    }
+    if (path_obj)
+        Tcl_DecrRefCount(path_obj);
+    delete command_cache;
+}
+
+bool Widget::exec_direct(const std::vector<ArgValue>& words, bool* success) const
+{
+    auto* p = checked_interp("exec_direct", success);
+    if (p == nullptr)
+        return false;
+
+    if (!impl_->command_cache)
+        impl_->command_cache = new WidgetCommandCache();
+
+    if (!p->exec_direct(*impl_->command_cache, impl_->full_name, words, path_obj()))
+    {
+        report_tcl_failure(*p, "exec_direct", success);
+        return false;
+    }
+    if (success) *success = true;
+    return true;
+}
+
+Tcl_Obj* Widget::path_obj() const
+{
+    // full_nameはImpl生成直後(ウィジェット生成時/nametowidget等)に一度だけ設定され以後変わらないため、
+    // 最初にcall()された時点で作ったTcl_Objをウィジェットの寿命の間使い回せる。
+    if (!impl_->path_obj && !impl_->full_name.empty())
+    {
+        impl_->path_obj = Tcl_NewStringObj(impl_->full_name.c_str(), (int)impl_->full_name.size());
+        Tcl_IncrRefCount(impl_->path_obj);
+    }
+    return impl_->path_obj;
+}
+
+std::string Widget::register_void_callback(const std::string& role, std::function<void()> callback) const
 {
     auto* p = checked_interp("register_void_callback");
-    if (p) p->register_void_callback(name, callback);
+    if (!p)
+        return "";
+    return p->adopt_callback(impl_->full_name, role, p->register_void_callback(std::move(callback)));
 }
 
-void Widget::register_string_callback(const std::string& name, std::function<void(const std::string&)> callback) const
+std::string Widget::register_string_callback(const std::string& role, std::function<void(const std::string&)> callback) const
 {
     auto* p = checked_interp("register_string_callback");
-    if (p) p->register_string_callback(name, callback);
+    if (!p)
+        return "";
+    return p->adopt_callback(impl_->full_name, role, p->register_string_callback(std::move(callback)));
 }
 
-void Widget::register_double_callback(const std::string& name, std::function<void(const double&)> callback) const
+std::string Widget::register_double_callback(const std::string& role, std::function<void(const double&)> callback) const
 {
     auto* p = checked_interp("register_double_callback");
-    if (p) p->register_double_callback(name, callback);
+    if (!p)
+        return "";
+    return p->adopt_callback(impl_->full_name, role, p->register_double_callback(std::move(callback)));
 }
 
-void Widget::register_event_callback(const std::string& name, std::function<void(const Event&)> callback) const
+std::string Widget::register_event_callback(const std::string& role, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce) const
 {
     auto* p = checked_interp("register_event_callback");
-    if (p) p->register_event_callback(name, callback);
+    if (!p)
+        return "";
+    return p->adopt_callback(impl_->full_name, role, p->register_event_callback(std::move(callback), fields, coalesce));
 }
 
-void Widget::register_bool_callback(const std::string& name, std::function<bool(const std::string&)> callback) const
+std::string Widget::register_bool_callback(const std::string& role, std::function<bool(const std::string&)> callback) const
 {
     auto* p = checked_interp("register_bool_callback");
-    if (p) p->register_bool_callback(name, callback);
+    if (!p)
+        return "";
+    return p->adopt_callback(impl_->full_name, role, p->register_bool_callback(std::move(callback)));
 }
 
-Widget& Widget::pack(const std::map<std::string, ArgValue> &options)
+Widget& Widget::pack(const Options& options)
 {
     std::vector<ArgValue> words = {"pack", impl_->full_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Widget& Widget::pack_forget()
 {
-    call({"pack", "forget", impl_->full_name});
+    exec({"pack", "forget", impl_->full_name});
     return *this;
 }
 
-Widget& Widget::grid(const std::map<std::string, ArgValue>& options)
+Widget& Widget::grid(const Options& options)
 {
     std::vector<ArgValue> words = {"grid", impl_->full_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Widget& Widget::grid_forget()
 {
-    call({"grid", "forget", impl_->full_name});
+    exec({"grid", "forget", impl_->full_name});
     return *this;
 }
 
-Widget& Widget::place(const std::map<std::string, ArgValue> &options)
+Widget& Widget::place(const Options& options)
 {
     std::vector<ArgValue> words = {"place", impl_->full_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Widget& Widget::place_forget()
 {
-    call({"place", "forget", impl_->full_name});
+    exec({"place", "forget", impl_->full_name});
     return *this;
 }
 
-Widget& Widget::config(const std::map<std::string, ArgValue> &options)
+Widget& Widget::config(const Options& options)
 {
     if (options.empty())
     {
@@ -977,12 +3614,8 @@ Widget& Widget::config(const std::map<std::string, ArgValue> &options)
     }
 
     std::vector<ArgValue> words = {impl_->full_name, "configure"};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -991,28 +3624,20 @@ Widget& Widget::config(const std::string& name, const ArgValue& value)
     config({{name, value}});
     return *this;
 }
-
-Widget& Widget::grid_rowconfigure(int row, const std::map<std::string, ArgValue>& options)
-{
-    std::vector<ArgValue> words = {"grid", "rowconfigure", impl_->full_name, row};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+
+Widget& Widget::grid_rowconfigure(int row, const Options& options)
+{
+    std::vector<ArgValue> words = {"grid", "rowconfigure", impl_->full_name, row};
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
-Widget& Widget::grid_columnconfigure(int column, const std::map<std::string, ArgValue>& options)
+Widget& Widget::grid_columnconfigure(int column, const Options& options)
 {
     std::vector<ArgValue> words = {"grid", "columnconfigure", impl_->full_name, column};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -1025,69 +3650,97 @@ std::string Widget::cget(const std::string& name) const
     return ret;
 }
 
-Widget& Widget::bind(const std::string& event, std::function<void(const Event&)> callback)
+Widget& Widget::bind(const std::string& event, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce)
 {
-    auto cb_name = sanitize(full_name()) + "_" + sanitize(event) + "_bind_cb";
-    register_event_callback(cb_name, callback);
-    std::string script = cb_name + " %x %y %X %Y %W %K %k %c %t %D";
-    call({"bind", impl_->full_name, event, script});
+    auto cb_name = register_event_callback("bind " + event, callback, fields, coalesce);
+    exec({"bind", impl_->full_name, event, Interpreter::event_script(cb_name, fields)});
     return *this;
 }
 
 Widget& Widget::unbind(const std::string& event)
 {
-    call({"bind", impl_->full_name, event, ""});
+    exec({"bind", impl_->full_name, event, ""});
+    auto* p = checked_interp("unbind");
+    if (p) p->release_callback(impl_->full_name, "bind " + event);
     return *this;
 }
 
-Widget& Widget::bind_all(const std::string& event, std::function<void(const Event&)> callback)
+// bind_all()/bind_class()のコールバックは特定のウィジェットに属さないため、ownerを空にして登録する
+// (ウィジェットの破棄では解放せず、同じイベントへの再登録で置き換えるだけ)。
+Widget& Widget::bind_all(const std::string& event, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce)
 {
-    auto cb_name = "all_" + sanitize(event) + "_bindall_cb";
-    register_event_callback(cb_name, callback);
-    std::string script = cb_name + " %x %y %X %Y %W %K %k %c %t %D";
-    call({"bind", "all", event, script});
+    auto* p = checked_interp("bind_all");
+    if (!p)
+        return *this;
+    auto cb_name = p->adopt_callback("", "bind_all " + event, p->register_event_callback(std::move(callback), fields, coalesce));
+    exec({"bind", "all", event, Interpreter::event_script(cb_name, fields)});
     return *this;
 }
 
 Widget& Widget::unbind_all(const std::string& event)
 {
-    call({"bind", "all", event, ""});
+    exec({"bind", "all", event, ""});
+    auto* p = checked_interp("unbind_all");
+    if (p) p->release_callback("", "bind_all " + event);
     return *this;
 }
 
-Widget& Widget::bind_class(const std::string& class_name, const std::string& event, std::function<void(const Event&)> callback)
+Widget& Widget::bind_class(const std::string& class_name, const std::string& event, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce)
 {
-    auto cb_name = sanitize(class_name) + "_" + sanitize(event) + "_bindclass_cb";
-    register_event_callback(cb_name, callback);
-    std::string script = cb_name + " %x %y %X %Y %W %K %k %c %t %D";
-    call({"bind", class_name, event, script});
+    auto* p = checked_interp("bind_class");
+    if (!p)
+        return *this;
+    auto cb_name = p->adopt_callback("", "bind_class " + class_name + " " + event, p->register_event_callback(std::move(callback), fields, coalesce));
+    exec({"bind", class_name, event, Interpreter::event_script(cb_name, fields)});
+    return *this;
+}
+
+Widget& Widget::unbind_class(const std::string& class_name, const std::string& event)
+{
+    exec({"bind", class_name, event, ""});
+    auto* p = checked_interp("unbind_class");
+    if (p) p->release_callback("", "bind_class " + class_name + " " + event);
     return *this;
 }
 
+// after()/after_idle()のコールバックは1回呼ばれた時点で(after_cancel()なら取り消した時点で)コマンドごと
+// 削除する。ウィジェットの破棄では削除しない(Tclのafterはウィジェットと無関係に発火するため)。
 std::string Widget::after(const int& ms, std::function<void()> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_after_cb_" + std::to_string(impl_->after_id++);
-    register_void_callback(cb_name, callback);
+    auto* p = checked_interp("after");
+    if (!p)
+        return "";
+    auto token   = p->register_oneshot_callback(std::move(callback));
+    auto cb_name = Interpreter::callback_command_name(token);
     auto ok  = false;
     auto ret = call({"after", ms, cb_name}, &ok);
+    if (!ok)
+        p->release_oneshot_callback(cb_name);
+    else
+        p->remember_after(ret, token);
     return ret;
 }
 
 void Widget::after_idle(std::function<void()> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_after_idle_cb";
-    register_void_callback(cb_name, callback);
-    call({"after", "idle", cb_name});
+    auto* p = checked_interp("after_idle");
+    if (!p)
+        return;
+    auto cb_name = Interpreter::callback_command_name(p->register_oneshot_callback(std::move(callback)));
+    exec({"after", "idle", cb_name});
 }
 
 void Widget::after_cancel(const std::string& id)
 {
-    call({"after", "cancel", id});
+    exec({"after", "cancel", id});
+    auto* p = checked_interp("after_cancel");
+    if (p)
+        p->cancel_after(id);
 }
 
 void Widget::destroy()
 {
-    call({"destroy", impl_->full_name});
+    exec_now({"destroy", impl_->full_name});
 }
 
 void Widget::update()
@@ -1100,69 +3753,56 @@ void Widget::update_idletasks()
     call({"update", "idletasks"});
 }
 
-void Widget::event_generate(const std::string& event, const std::map<std::string, ArgValue>& options)
+void Widget::event_generate(const std::string& event, const Options& options)
 {
     std::vector<ArgValue> words = {"event", "generate", impl_->full_name, event};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec_now(words);
 }
 
 int Widget::winfo_width() const
 {
-    auto ret = call({"winfo", "width", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "width", impl_->full_name});
 }
 
 int Widget::winfo_height() const
 {
-    auto ret = call({"winfo", "height", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "height", impl_->full_name});
 }
 
 int Widget::winfo_reqwidth() const
 {
-    auto ret = call({"winfo", "reqwidth", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "reqwidth", impl_->full_name});
 }
 
 int Widget::winfo_reqheight() const
 {
-    auto ret = call({"winfo", "reqheight", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "reqheight", impl_->full_name});
 }
 
 int Widget::winfo_x() const
 {
-    auto ret = call({"winfo", "x", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "x", impl_->full_name});
 }
 
 int Widget::winfo_y() const
 {
-    auto ret = call({"winfo", "y", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "y", impl_->full_name});
 }
 
 int Widget::winfo_rootx() const
 {
-    auto ret = call({"winfo", "rootx", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "rootx", impl_->full_name});
 }
 
 int Widget::winfo_rooty() const
 {
-    auto ret = call({"winfo", "rooty", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "rooty", impl_->full_name});
 }
 
 bool Widget::winfo_exists() const
 {
-    auto ret = call({"winfo", "exists", impl_->full_name});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({"winfo", "exists", impl_->full_name});
 }
 
 std::string Widget::winfo_class() const
@@ -1177,8 +3817,7 @@ std::string Widget::winfo_toplevel() const
 
 std::vector<std::string> Widget::winfo_children() const
 {
-    auto result = call({"winfo", "children", impl_->full_name});
-    return impl_->interp->split_list(result);
+    return call_list({"winfo", "children", impl_->full_name});
 }
 
 Widget Widget::nametowidget(const std::string& name) const
@@ -1191,20 +3830,17 @@ Widget Widget::nametowidget(const std::string& name) const
 
 std::vector<std::string> Widget::grid_slaves() const
 {
-    auto result = call({"grid", "slaves", impl_->full_name});
-    return impl_->interp->split_list(result);
+    return call_list({"grid", "slaves", impl_->full_name});
 }
 
 std::vector<std::string> Widget::pack_slaves() const
 {
-    auto result = call({"pack", "slaves", impl_->full_name});
-    return impl_->interp->split_list(result);
+    return call_list({"pack", "slaves", impl_->full_name});
 }
 
 std::vector<std::string> Widget::place_slaves() const
 {
-    auto result = call({"place", "slaves", impl_->full_name});
-    return impl_->interp->split_list(result);
+    return call_list({"place", "slaves", impl_->full_name});
 }
 
 // grid/pack/place infoの共通実装。戻り値は"-key1 val1 -key2 val2 ..."形式なので、
@@ -1249,26 +3885,22 @@ std::map<std::string, std::string> Widget::place_info() const
 
 int Widget::winfo_screenwidth() const
 {
-    auto ret = call({"winfo", "screenwidth", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "screenwidth", impl_->full_name});
 }
 
 int Widget::winfo_screenheight() const
 {
-    auto ret = call({"winfo", "screenheight", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "screenheight", impl_->full_name});
 }
 
 int Widget::winfo_pointerx() const
 {
-    auto ret = call({"winfo", "pointerx", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "pointerx", impl_->full_name});
 }
 
 int Widget::winfo_pointery() const
 {
-    auto ret = call({"winfo", "pointery", impl_->full_name});
-    return safe_stol(ret.c_str());
+    return call_int({"winfo", "pointery", impl_->full_name});
 }
 
 std::string Widget::winfo_manager() const
@@ -1278,19 +3910,18 @@ std::string Widget::winfo_manager() const
 
 bool Widget::winfo_ismapped() const
 {
-    auto ret = call({"winfo", "ismapped", impl_->full_name});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({"winfo", "ismapped", impl_->full_name});
 }
 
 Widget& Widget::focus_set()
 {
-    call({"focus", impl_->full_name});
+    exec_now({"focus", impl_->full_name});
     return *this;
 }
 
 Widget& Widget::focus_force()
 {
-    call({"focus", "-force", impl_->full_name});
+    exec_now({"focus", "-force", impl_->full_name});
     return *this;
 }
 
@@ -1303,12 +3934,17 @@ std::string Widget::focus_get() const
 
 void Widget::clipboard_clear()
 {
-    call({"clipboard", "clear"});
+    exec_now({"clipboard", "clear"});
 }
 
 void Widget::clipboard_append(const std::string& text)
 {
-    call({"clipboard", "append", text});
+    clipboard_append(StringRef(text));
+}
+
+void Widget::clipboard_append(const StringRef& text)
+{
+    exec_now({"clipboard", "append", text});
 }
 
 std::string Widget::clipboard_get() const
@@ -1335,13 +3971,13 @@ void Widget::wait_visibility() const
 
 Widget& Widget::lift()
 {
-    call({"raise", impl_->full_name});
+    exec({"raise", impl_->full_name});
     return *this;
 }
 
 Widget& Widget::lower()
 {
-    call({"lower", impl_->full_name});
+    exec({"lower", impl_->full_name});
     return *this;
 }
 
@@ -1352,30 +3988,28 @@ std::string Widget::windowingsystem() const
 
 void Widget::bell()
 {
-    call({"bell"});
+    exec({"bell"});
 }
 
 double Widget::scaling() const
 {
-    auto ret = call({"tk", "scaling"});
-    return safe_stod(ret.c_str());
+    return call_double({"tk", "scaling"});
 }
 
 Widget& Widget::scaling(double factor)
 {
-    call({"tk", "scaling", factor});
+    exec({"tk", "scaling", factor});
     return *this;
 }
 
 std::vector<std::string> Widget::bindtags() const
 {
-    auto ret = call({"bindtags", impl_->full_name});
-    return impl_->interp->split_list(ret);
+    return call_list({"bindtags", impl_->full_name});
 }
 
 Widget& Widget::bindtags(const std::vector<std::string>& tags)
 {
-    call({"bindtags", impl_->full_name, std::vector<ArgValue>(tags.begin(), tags.end())});
+    exec({"bindtags", impl_->full_name, std::vector<ArgValue>(tags.begin(), tags.end())});
     return *this;
 }
 
@@ -1409,7 +4043,7 @@ std::string Widget::winfo_parent() const
 
 int Widget::winfo_depth() const
 {
-    return safe_stol(call({"winfo", "depth", impl_->full_name}).c_str());
+    return call_int({"winfo", "depth", impl_->full_name});
 }
 
 std::string Widget::winfo_geometry() const
@@ -1428,9 +4062,9 @@ std::string Widget::winfo_containing(int root_x, int root_y) const
 void Widget::option_add(const std::string& pattern, const std::string& value, const std::string& priority)
 {
     if (priority.empty())
-        call({"option", "add", pattern, value});
+        exec_now({"option", "add", pattern, value});
     else
-        call({"option", "add", pattern, value, priority});
+        exec_now({"option", "add", pattern, value, priority});
 }
 
 std::string Widget::option_get(const std::string& name, const std::string& class_name) const
@@ -1453,18 +4087,13 @@ Widget Widget::tk_focusPrev() const
     return nametowidget(ret);
 }
 
-PhotoImage::PhotoImage(const std::map<std::string, ArgValue>& options)
+PhotoImage::PhotoImage(const Options& options)
     : interp_(current_interp())
 {
     name_ = "img_" + id;
     std::vector<ArgValue> words = {"image", "create", "photo", name_};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-
-    call(words);
+    options.append_to(words);
+    exec_now(words);
 }
 
 const std::string& PhotoImage::name() const
@@ -1474,18 +4103,19 @@ const std::string& PhotoImage::name() const
 
 void PhotoImage::destroy()
 {
-    call({"image", "delete", name_});
+    exec_now({"image", "delete", name_});
+}
+
+PhotoImage& PhotoImage::put(const std::string& data, const Options& options)
+{
+    return put(StringRef(data), options);
 }
 
-PhotoImage& PhotoImage::put(const std::string& data, const std::map<std::string, ArgValue>& options)
+PhotoImage& PhotoImage::put(const StringRef& data, const Options& options)
 {
     std::vector<ArgValue> words = {name_, "put", data};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -1496,19 +4126,15 @@ std::string PhotoImage::get(int x, int y) const
 
 PhotoImage& PhotoImage::blank()
 {
-    call({name_, "blank"});
+    exec({name_, "blank"});
     return *this;
 }
 
-PhotoImage& PhotoImage::copy_from(const PhotoImage& source, const std::map<std::string, ArgValue>& options)
+PhotoImage& PhotoImage::copy_from(const PhotoImage& source, const Options& options)
 {
     std::vector<ArgValue> words = {name_, "copy", source.name_};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -1517,7 +4143,7 @@ PhotoImage PhotoImage::copy() const
     // デフォルト引数のPhotoImage()はcurrent_interp()に束縛された空のphotoイメージを既に
     // 生成済みのため、明示的な"image create photo"の再呼び出しは不要。
     PhotoImage result;
-    call({result.name_, "copy", name_});
+    exec({result.name_, "copy", name_});
     return result;
 }
 
@@ -1525,9 +4151,9 @@ PhotoImage PhotoImage::zoom(int x, int y) const
 {
     PhotoImage result;
     if (y > 0)
-        call({result.name_, "copy", name_, "-zoom", x, y});
+        exec({result.name_, "copy", name_, "-zoom", x, y});
     else
-        call({result.name_, "copy", name_, "-zoom", x});
+        exec({result.name_, "copy", name_, "-zoom", x});
     return result;
 }
 
@@ -1535,33 +4161,29 @@ PhotoImage PhotoImage::subsample(int x, int y) const
 {
     PhotoImage result;
     if (y > 0)
-        call({result.name_, "copy", name_, "-subsample", x, y});
+        exec({result.name_, "copy", name_, "-subsample", x, y});
     else
-        call({result.name_, "copy", name_, "-subsample", x});
+        exec({result.name_, "copy", name_, "-subsample", x});
     return result;
 }
 
 int PhotoImage::width() const
 {
-    return safe_stol(call({"image", "width", name_}).c_str());
+    return call_int({"image", "width", name_});
 }
 
 int PhotoImage::height() const
 {
-    return safe_stol(call({"image", "height", name_}).c_str());
+    return call_int({"image", "height", name_});
 }
 
-BitmapImage::BitmapImage(const std::map<std::string, ArgValue>& options)
+BitmapImage::BitmapImage(const Options& options)
     : interp_(current_interp())
 {
     name_ = "bmp_" + id;
     std::vector<ArgValue> words = {"image", "create", "bitmap", name_};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec_now(words);
 }
 
 const std::string& BitmapImage::name() const
@@ -1571,41 +4193,48 @@ const std::string& BitmapImage::name() const
 
 void BitmapImage::destroy()
 {
-    call({"image", "delete", name_});
+    exec_now({"image", "delete", name_});
 }
 
 int BitmapImage::width() const
 {
-    return safe_stol(call({"image", "width", name_}).c_str());
+    return call_int({"image", "width", name_});
 }
 
 int BitmapImage::height() const
 {
-    return safe_stol(call({"image", "height", name_}).c_str());
+    return call_int({"image", "height", name_});
 }
 
 std::vector<std::string> image_names()
 {
     auto* interp = current_interp();
     bool ok = false;
-    auto ret = interp->call({"image", "names"}, &ok);
-    if (!ok) return {};
-    return interp->split_list(ret);
+    if (!interp->eval({"image", "names"}))
+    {
+        report_tcl_failure(*interp, "image_names", &ok);
+        return {};
+    }
+    return interp->result_list();
 }
 
 std::vector<std::string> image_types()
 {
     auto* interp = current_interp();
     bool ok = false;
-    auto ret = interp->call({"image", "types"}, &ok);
-    if (!ok) return {};
-    return interp->split_list(ret);
+    if (!interp->eval({"image", "types"}))
+    {
+        report_tcl_failure(*interp, "image_types", &ok);
+        return {};
+    }
+    return interp->result_list();
 }
 
 Tk::Tk()
     : Widget()
 {
     impl_->interp = current_interp();
+    impl_->interp->ensure_tk();
     impl_->full_name = ".";
 
     title("tk");
@@ -1616,13 +4245,13 @@ Tk::Tk()
 
 Tk& Tk::title(const std::string& title)
 {
-    call({"wm", "title", ".", title});
+    exec({"wm", "title", ".", title});
     return *this;
 }
 
 Tk& Tk::geometry(const std::string &size)
 {
-    call({"wm", "geometry", ".", size});
+    exec({"wm", "geometry", ".", size});
     return *this;
 }
 
@@ -1633,63 +4262,61 @@ std::string Tk::geometry() const
 
 Tk& Tk::protocol(const std::string& name, std::function<void()> handler) 
 {
-    auto cb_name = "protocol_cb_" + sanitize(name);
-    register_void_callback(cb_name, handler);
-    call({"wm", "protocol", ".", name, cb_name});
+    auto cb_name = register_void_callback("protocol " + name, handler);
+    exec({"wm", "protocol", ".", name, cb_name});
     return *this;
 }
 
 Tk& Tk::resizable(bool width, bool height)
 {
-    call({"wm", "resizable", ".", (int)(width ? 1 : 0), (int)(height ? 1 : 0)});
+    exec({"wm", "resizable", ".", (int)(width ? 1 : 0), (int)(height ? 1 : 0)});
     return *this;
 }
 
 Tk& Tk::overrideredirect(bool value)
 {
-    call({"wm", "overrideredirect", ".", (int)(value ? 1 : 0)});
+    exec({"wm", "overrideredirect", ".", (int)(value ? 1 : 0)});
     return *this;
 }
 
 bool Tk::overrideredirect() const
 {
-    auto ret = call({"wm", "overrideredirect", "."});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({"wm", "overrideredirect", "."});
 }
 
 Tk& Tk::minsize(int width, int height)
 {
-    call({"wm", "minsize", ".", width, height});
+    exec({"wm", "minsize", ".", width, height});
     return *this;
 }
 
 Tk& Tk::maxsize(int width, int height)
 {
-    call({"wm", "maxsize", ".", width, height});
+    exec({"wm", "maxsize", ".", width, height});
     return *this;
 }
 
 Tk& Tk::iconify()
 {
-    call({"wm", "iconify", "."});
+    exec({"wm", "iconify", "."});
     return *this;
 }
 
 Tk& Tk::deiconify()
 {
-    call({"wm", "deiconify", "."});
+    exec({"wm", "deiconify", "."});
     return *this;
 }
 
 Tk& Tk::withdraw()
 {
-    call({"wm", "withdraw", "."});
+    exec({"wm", "withdraw", "."});
     return *this;
 }
 
 Tk& Tk::state(const std::string& new_state)
 {
-    call({"wm", "state", ".", new_state});
+    exec({"wm", "state", ".", new_state});
     return *this;
 }
 
@@ -1700,7 +4327,7 @@ std::string Tk::state() const
 
 Tk& Tk::attributes(const std::string& name, const std::string& value)
 {
-    call({"wm", "attributes", ".", name, value});
+    exec({"wm", "attributes", ".", name, value});
     return *this;
 }
 
@@ -1711,43 +4338,43 @@ std::string Tk::attributes(const std::string& name) const
 
 Tk& Tk::lift()
 {
-    call({"raise", "."});
+    exec({"raise", "."});
     return *this;
 }
 
 Tk& Tk::lower()
 {
-    call({"lower", "."});
+    exec({"lower", "."});
     return *this;
 }
 
 Tk& Tk::grab_set()
 {
-    call({"grab", "set", "."});
+    exec_now({"grab", "set", "."});
     return *this;
 }
 
 Tk& Tk::grab_release()
 {
-    call({"grab", "release", "."});
+    exec_now({"grab", "release", "."});
     return *this;
 }
 
 Tk& Tk::iconphoto(const std::string& image_name)
 {
-    call({"wm", "iconphoto", ".", "-default", image_name});
+    exec({"wm", "iconphoto", ".", "-default", image_name});
     return *this;
 }
 
 Tk& Tk::iconbitmap(const std::string& bitmap_path)
 {
-    call({"wm", "iconbitmap", ".", bitmap_path});
+    exec({"wm", "iconbitmap", ".", bitmap_path});
     return *this;
 }
 
 Tk& Tk::iconname(const std::string& name)
 {
-    call({"wm", "iconname", ".", name});
+    exec({"wm", "iconname", ".", name});
     return *this;
 }
 
@@ -1766,7 +4393,7 @@ void Tk::quit()
     call({"set", "forever", 1});
 }
 
-Checkbutton::Checkbutton(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Checkbutton::Checkbutton(const Widget& parent, const Options& options)
     : Widget(parent, "checkbutton", "chk", options)
 {
 }
@@ -1785,8 +4412,7 @@ Checkbutton& Checkbutton::variable(Var& var)
 
 Checkbutton& Checkbutton::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_chk_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
@@ -1796,7 +4422,7 @@ std::string Checkbutton::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Frame::Frame(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Frame::Frame(const Widget& parent, const Options& options)
     : Widget(parent, "frame", "f", options)
 {
 }
@@ -1815,11 +4441,11 @@ Frame& Frame::height(const int &height)
 
 Frame& Frame::grid_propagate(const bool& value)
 {
-    call({"grid", "propagate", impl_->full_name, (int)(value ? 1 : 0)});
+    exec({"grid", "propagate", impl_->full_name, (int)(value ? 1 : 0)});
     return *this;
 }
 
-Toplevel::Toplevel(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Toplevel::Toplevel(const Widget& parent, const Options& options)
     : Widget(parent, "toplevel", "toplevel", options)
 {
     auto self_handle = handle();
@@ -1828,13 +4454,13 @@ Toplevel::Toplevel(const Widget& parent, const std::map<std::string, ArgValue>&
 
 Toplevel& Toplevel::title(const std::string &title_text)
 {
-    call({"wm", "title", impl_->full_name, title_text});
+    exec({"wm", "title", impl_->full_name, title_text});
     return *this;
 }
 
 Toplevel& Toplevel::geometry(const std::string &size)
 {
-    call({"wm", "geometry", impl_->full_name, size});
+    exec({"wm", "geometry", impl_->full_name, size});
     return *this;
 }
 
@@ -1845,45 +4471,43 @@ std::string Toplevel::geometry() const
 
 Toplevel& Toplevel::protocol(const std::string& name, std::function<void()> handler) 
 {
-    std::string callback_name = "protocol_cb_" + sanitize(full_name()) + "_" + sanitize(name);
-    register_void_callback(callback_name, handler);
-    call({"wm", "protocol", impl_->full_name, name, callback_name});
+    auto callback_name = register_void_callback("protocol " + name, handler);
+    exec({"wm", "protocol", impl_->full_name, name, callback_name});
     return *this;
 }
 
 Toplevel& Toplevel::resizable(bool width, bool height)
 {
-    call({"wm", "resizable", impl_->full_name, (int)(width ? 1 : 0), (int)(height ? 1 : 0)});
+    exec({"wm", "resizable", impl_->full_name, (int)(width ? 1 : 0), (int)(height ? 1 : 0)});
     return *this;
 }
 
 Toplevel& Toplevel::overrideredirect(bool value)
 {
-    call({"wm", "overrideredirect", impl_->full_name, (int)(value ? 1 : 0)});
+    exec({"wm", "overrideredirect", impl_->full_name, (int)(value ? 1 : 0)});
     return *this;
 }
 
 bool Toplevel::overrideredirect() const
 {
-    auto ret = call({"wm", "overrideredirect", impl_->full_name});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({"wm", "overrideredirect", impl_->full_name});
 }
 
 Toplevel& Toplevel::minsize(int width, int height)
 {
-    call({"wm", "minsize", impl_->full_name, width, height});
+    exec({"wm", "minsize", impl_->full_name, width, height});
     return *this;
 }
 
 Toplevel& Toplevel::maxsize(int width, int height)
 {
-    call({"wm", "maxsize", impl_->full_name, width, height});
+    exec({"wm", "maxsize", impl_->full_name, width, height});
     return *this;
 }
 
 Toplevel& Toplevel::attributes(const std::string& name, const std::string& value)
 {
-    call({"wm", "attributes", impl_->full_name, name, value});
+    exec({"wm", "attributes", impl_->full_name, name, value});
     return *this;
 }
 
@@ -1894,25 +4518,25 @@ std::string Toplevel::attributes(const std::string& name) const
 
 Toplevel& Toplevel::iconify()
 {
-    call({"wm", "iconify", impl_->full_name});
+    exec({"wm", "iconify", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::deiconify()
 {
-    call({"wm", "deiconify", impl_->full_name});
+    exec({"wm", "deiconify", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::withdraw()
 {
-    call({"wm", "withdraw", impl_->full_name});
+    exec({"wm", "withdraw", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::state(const std::string& new_state)
 {
-    call({"wm", "state", impl_->full_name, new_state});
+    exec({"wm", "state", impl_->full_name, new_state});
     return *this;
 }
 
@@ -1923,43 +4547,43 @@ std::string Toplevel::state() const
 
 Toplevel& Toplevel::lift()
 {
-    call({"raise", impl_->full_name});
+    exec({"raise", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::lower()
 {
-    call({"lower", impl_->full_name});
+    exec({"lower", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::grab_set()
 {
-    call({"grab", "set", impl_->full_name});
+    exec_now({"grab", "set", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::grab_release()
 {
-    call({"grab", "release", impl_->full_name});
+    exec_now({"grab", "release", impl_->full_name});
     return *this;
 }
 
 Toplevel& Toplevel::iconphoto(const std::string& image_name)
 {
-    call({"wm", "iconphoto", impl_->full_name, "-default", image_name});
+    exec({"wm", "iconphoto", impl_->full_name, "-default", image_name});
     return *this;
 }
 
 Toplevel& Toplevel::iconbitmap(const std::string& bitmap_path)
 {
-    call({"wm", "iconbitmap", impl_->full_name, bitmap_path});
+    exec({"wm", "iconbitmap", impl_->full_name, bitmap_path});
     return *this;
 }
 
 Toplevel& Toplevel::iconname(const std::string& name)
 {
-    call({"wm", "iconname", impl_->full_name, name});
+    exec({"wm", "iconname", impl_->full_name, name});
     return *this;
 }
 
@@ -1970,11 +4594,11 @@ std::string Toplevel::iconname() const
 
 Toplevel& Toplevel::transient(const Widget& master)
 {
-    call({"wm", "transient", impl_->full_name, master.full_name()});
+    exec({"wm", "transient", impl_->full_name, master.full_name()});
     return *this;
 }
 
-Button::Button(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Button::Button(const Widget& parent, const Options& options)
     : Widget(parent, "button", "b", options)
 {
 }
@@ -1999,8 +4623,7 @@ Button& Button::text(const std::string& text)
 
 Button& Button::command(std::function<void()> callback)
 {
-    std::string callback_name =  sanitize(full_name()) + "_void_cb";
-    register_void_callback(callback_name, callback);
+    auto callback_name = register_void_callback("command", callback);
     config({{"command", callback_name}});
     return *this;
 }
@@ -2010,20 +4633,16 @@ std::string Button::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Canvas::Canvas(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Canvas::Canvas(const Widget& parent, const Options& options)
     : Widget(parent, "canvas", "c", options)
 {
 }
 
-Canvas& Canvas::itemconfig(const std::string& id_or_tag, const std::map<std::string, ArgValue>& options)
+Canvas& Canvas::itemconfig(const std::string& id_or_tag, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "itemconfigure", id_or_tag};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec_direct(words);
     return *this;
 }
 
@@ -2036,172 +4655,136 @@ std::string Canvas::itemcget(const std::string& id_or_tag, const std::string& op
 
 std::vector<int> Canvas::bbox(const std::string& id_or_tag) const
 {
-    auto ok     = false;
-    auto result = call({impl_->full_name, "bbox", id_or_tag}, &ok);
-
-    std::vector<int> box;
-    if (!ok)
-        return box;
-
-    for (const auto& token : impl_->interp->split_list(result))
-        box.push_back(safe_stol(token.c_str()));
-    return box;
+    // 失敗時(該当アイテム無し等)は例外を投げず空を返す(call_int_list()は失敗時に空を返す)。
+    auto ok = false;
+    return call_int_list({impl_->full_name, "bbox", id_or_tag}, &ok);
 }
 
-Canvas& Canvas::tag_bind(const std::string& id_or_tag, const std::string& event, std::function<void(const Event&)> callback)
+Canvas& Canvas::tag_bind(const std::string& id_or_tag, const std::string& event, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce)
 {
-    auto cb_name = sanitize(full_name()) + "_tag_" + sanitize(id_or_tag) + "_" + sanitize(event);
-    register_event_callback(cb_name, callback);
-    std::string script = cb_name + " %x %y %X %Y %W %K %k %c %t %D";
-    call({impl_->full_name, "bind", id_or_tag, event, script});
+    auto cb_name = register_event_callback("tag " + id_or_tag + " " + event, callback, fields, coalesce);
+    exec({impl_->full_name, "bind", id_or_tag, event, Interpreter::event_script(cb_name, fields)});
     return *this;
 }
 
 Canvas& Canvas::tag_unbind(const std::string& id_or_tag, const std::string& event)
 {
-    call({impl_->full_name, "bind", id_or_tag, event, ""});
+    exec({impl_->full_name, "bind", id_or_tag, event, ""});
+    auto* p = checked_interp("tag_unbind");
+    if (p) p->release_callback(impl_->full_name, "tag " + id_or_tag + " " + event);
     return *this;
 }
 
-std::string Canvas::create_line(const std::vector<std::array<double, 2>>& points, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_line(const std::vector<std::array<double, 2>>& points, const Options& options)
 {
-    std::vector<ArgValue> words = {impl_->full_name, "create", "line"};
+    // 点列は"create line coordList"形式の1語にまとめる(点ごとに2語ずつArgValueを作らない)。
+    std::vector<double> flat;
+    flat.reserve(points.size() * 2);
     for (const auto& pt : points)
     {
-        words.push_back(pt[0]);
-        words.push_back(pt[1]);
-    }
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
+        flat.push_back(pt[0]);
+        flat.push_back(pt[1]);
     }
+    std::vector<ArgValue> words = {impl_->full_name, "create", "line", DoubleArrayRef(flat)};
+    options.append_to(words);
+    return call(words);
+}
+
+std::string Canvas::create_line(const TclValue& coords, const Options& options)
+{
+    std::vector<ArgValue> words = {impl_->full_name, "create", "line", coords};
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_line(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_line(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "line", x1, y1, x2, y2};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_oval(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_oval(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "oval", x1, y1, x2, y2};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_rectangle(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_rectangle(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "rectangle", x1, y1, x2, y2};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_text(const int& x, const int& y, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_text(const int& x, const int& y, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "text", x, y};
-    for (const auto &kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_polygon(const std::vector<int>& coords, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_polygon(const std::vector<int>& coords, const Options& options)
 {
-    std::vector<ArgValue> words = {impl_->full_name, "create", "polygon"};
-    for (int c : coords)
-        words.push_back(c);
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    std::vector<ArgValue> words = {impl_->full_name, "create", "polygon", IntArrayRef(coords)};
+    options.append_to(words);
+    return call(words);
+}
+
+std::string Canvas::create_polygon(const TclValue& coords, const Options& options)
+{
+    std::vector<ArgValue> words = {impl_->full_name, "create", "polygon", coords};
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_arc(int x1, int y1, int x2, int y2, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_arc(int x1, int y1, int x2, int y2, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "arc", x1, y1, x2, y2};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_image(int x, int y, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_image(int x, int y, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "image", x, y};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_bitmap(int x, int y, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_bitmap(int x, int y, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "bitmap", x, y};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-std::string Canvas::create_window(int x, int y, const Widget& widget, const std::map<std::string, ArgValue>& options)
+std::string Canvas::create_window(int x, int y, const Widget& widget, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "create", "window", x, y, "-window", widget.full_name()};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
 std::vector<std::string> Canvas::find_overlapping(int x1, int y1, int x2, int y2) const
 {
-    auto result = call({impl_->full_name, "find", "overlapping", x1, y1, x2, y2});
-    return impl_->interp->split_list(result);
+    return call_list({impl_->full_name, "find", "overlapping", x1, y1, x2, y2});
 }
 
 std::vector<std::string> Canvas::find_closest(int x, int y) const
 {
-    auto result = call({impl_->full_name, "find", "closest", x, y});
-    return impl_->interp->split_list(result);
+    return call_list({impl_->full_name, "find", "closest", x, y});
 }
 
 std::vector<std::string> Canvas::find_all() const
 {
-    auto result = call({impl_->full_name, "find", "all"});
-    return impl_->interp->split_list(result);
+    return call_list({impl_->full_name, "find", "all"});
 }
 
 std::vector<std::string> Canvas::find_withtag(const std::string& tag_or_id) const
 {
-    auto result = call({impl_->full_name, "find", "withtag", tag_or_id});
-    return impl_->interp->split_list(result);
+    return call_list({impl_->full_name, "find", "withtag", tag_or_id});
 }
 
 Canvas& Canvas::tag_raise(const std::string& id_or_tag, const std::string& above_this)
@@ -2209,7 +4792,7 @@ Canvas& Canvas::tag_raise(const std::string& id_or_tag, const std::string& above
     std::vector<ArgValue> words = {impl_->full_name, "raise", id_or_tag};
     if (!above_this.empty())
         words.push_back(above_this);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -2218,58 +4801,58 @@ Canvas& Canvas::tag_lower(const std::string& id_or_tag, const std::string& below
     std::vector<ArgValue> words = {impl_->full_name, "lower", id_or_tag};
     if (!below_this.empty())
         words.push_back(below_this);
-    call(words);
+    exec(words);
     return *this;
 }
 
 double Canvas::canvasx(int screen_x) const
 {
-    auto ret = call({impl_->full_name, "canvasx", screen_x});
-    return safe_stod(ret.c_str());
+    return call_double({impl_->full_name, "canvasx", screen_x});
 }
 
 double Canvas::canvasy(int screen_y) const
 {
-    auto ret = call({impl_->full_name, "canvasy", screen_y});
-    return safe_stod(ret.c_str());
+    return call_double({impl_->full_name, "canvasy", screen_y});
 }
 
 Canvas& Canvas::addtag(const std::string& tag, const std::string& where, const std::string& target)
 {
-    call({impl_->full_name, "addtag", tag, where, target});
+    exec({impl_->full_name, "addtag", tag, where, target});
     return *this;
 }
 
 Canvas& Canvas::dtag(const std::string& tag, const std::string& target)
 {
-    call({impl_->full_name, "dtag", target, tag});
+    exec({impl_->full_name, "dtag", target, tag});
     return *this;
 }
 
 std::vector<std::string> Canvas::gettags(const std::string& id) const
 {
-    auto result = call({impl_->full_name, "gettags", id});
-    return impl_->interp->split_list(result);
+    return call_list({impl_->full_name, "gettags", id});
 }
 
 Canvas& Canvas::coords(const std::string& item_id, const std::vector<int>& coords)
 {
-    std::vector<ArgValue> words = {impl_->full_name, "coords", item_id};
-    for (int c : coords)
-        words.push_back(c);
-    call(words);
+    exec_direct({impl_->full_name, "coords", item_id, IntArrayRef(coords)});
+    return *this;
+}
+
+Canvas& Canvas::coords(const std::string& item_id, const TclValue& coords)
+{
+    exec_direct({impl_->full_name, "coords", item_id, coords});
     return *this;
 }
 
 Canvas& Canvas::move(const std::string& id_or_tag, const int& x, const int& y)
 {
-    call({impl_->full_name, "move", id_or_tag, x, y});
+    exec_direct({impl_->full_name, "move", id_or_tag, x, y});
     return *this;
 }
 
 Canvas& Canvas::moveto(const std::string& id_or_tag, const int& x, const int& y)
 {
-    call({impl_->full_name, "moveto", id_or_tag, x, y});
+    exec_direct({impl_->full_name, "moveto", id_or_tag, x, y});
     return *this;
 }
 
@@ -2278,7 +4861,7 @@ Canvas& Canvas::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -2287,35 +4870,33 @@ Canvas& Canvas::yview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "yview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Canvas& Canvas::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(impl_->full_name) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
 
 Canvas& Canvas::yscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(impl_->full_name) + "_ystring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("yscrollcommand", callback);
     config({{"yscrollcommand", cb_name}});
     return *this;
 }
 
 Canvas& Canvas::scale(const std::string& id_or_tag, const int& x, const int& y, const double& xscale, const double& yscale)
 {
-    call({impl_->full_name, "scale", id_or_tag, x, y, xscale, yscale});
+    exec({impl_->full_name, "scale", id_or_tag, x, y, xscale, yscale});
     return *this;
 }
 
 Canvas& Canvas::erase(const std::string& id_or_tag)
 {
-    call({impl_->full_name, "delete", id_or_tag});
+    exec({impl_->full_name, "delete", id_or_tag});
     return *this;
 }
 
@@ -2331,18 +4912,14 @@ Canvas& Canvas::height(const int &height)
     return *this;
 }
 
-std::string Canvas::postscript(const std::map<std::string, ArgValue>& options)
+std::string Canvas::postscript(const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "postscript"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-Entry::Entry(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Entry::Entry(const Widget& parent, const Options& options)
     : Widget(parent, "entry", "e", options)
 {
 }
@@ -2361,13 +4938,13 @@ Entry& Entry::state(const std::string& state)
 
 Entry& Entry::icursor(const std::string& index)
 {
-    call({impl_->full_name, "icursor", index});
+    exec({impl_->full_name, "icursor", index});
     return *this;
 }
 
 Entry& Entry::insert(const std::string& index, const std::string& text)
 {
-    call({impl_->full_name, "insert", index, text});
+    exec({impl_->full_name, "insert", index, text});
     return *this;
 }
 
@@ -2385,7 +4962,7 @@ Entry& Entry::erase(const std::string& start, const std::string& end)
     std::vector<ArgValue> words = {impl_->full_name, "delete", start};
     if (!end.empty())
         words.push_back(end);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -2398,8 +4975,7 @@ std::string Entry::get() const
 
 Entry& Entry::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
@@ -2409,37 +4985,35 @@ Entry& Entry::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Entry& Entry::select_range(const std::string& start, const std::string& end)
 {
-    call({impl_->full_name, "selection", "range", start, end});
+    exec({impl_->full_name, "selection", "range", start, end});
     return *this;
 }
 
 Entry& Entry::selection_clear()
 {
-    call({impl_->full_name, "selection", "clear"});
+    exec({impl_->full_name, "selection", "clear"});
     return *this;
 }
 
 bool Entry::select_present() const
 {
-    auto ret = call({impl_->full_name, "selection", "present"});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "selection", "present"});
 }
 
 Entry& Entry::validate(const std::string& mode, std::function<bool(const std::string&)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_validate_cb";
-    register_bool_callback(cb_name, callback);
+    auto cb_name = register_bool_callback("validatecommand", callback);
     config({{"validate", mode}, {"validatecommand", cb_name + " %P"}});
     return *this;
 }
 
-Label::Label(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Label::Label(const Widget& parent, const Options& options)
     : Widget(parent, "label", "l", options)
 {
 }
@@ -2450,7 +5024,7 @@ Label& Label::text(const std::string &text)
     return *this;
 }
 
-LabelFrame::LabelFrame(const Widget& parent, const std::map<std::string, ArgValue>& options)
+LabelFrame::LabelFrame(const Widget& parent, const Options& options)
     : Widget(parent, "labelframe", "labelframe", options)
 {
 }
@@ -2473,14 +5047,14 @@ LabelFrame& LabelFrame::text(const std::string& text)
     return *this;
 }
 
-Listbox::Listbox(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Listbox::Listbox(const Widget& parent, const Options& options)
     : Widget(parent, "listbox", "listbox", options)
 {
 }
 
 Listbox& Listbox::insert(const std::string& index, const std::string& item)
 {
-    call({impl_->full_name, "insert", index, item});
+    exec({impl_->full_name, "insert", index, item});
     return *this;
 }
 
@@ -2489,17 +5063,13 @@ Listbox& Listbox::erase(const std::string& start, const std::string& end)
     std::vector<ArgValue> words = {impl_->full_name, "delete", start};
     if (!end.empty())
         words.push_back(end);
-    call(words);
+    exec(words);
     return *this;
 }
 
 std::vector<int> Listbox::curselection() const
 {
-    std::string result = call({impl_->full_name, "curselection"});
-    std::vector<int> indices;
-    for (const auto& token : impl_->interp->split_list(result))
-        indices.push_back(safe_stol(token.c_str()));
-    return indices;
+    return call_int_list({impl_->full_name, "curselection"});
 }
 
 std::string Listbox::get(const std::string& index) const
@@ -2509,8 +5079,7 @@ std::string Listbox::get(const std::string& index) const
 
 Listbox& Listbox::yscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_ystring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("yscrollcommand", callback);
     config({{"yscrollcommand", cb_name}});
     return *this;
 }
@@ -2520,14 +5089,13 @@ Listbox& Listbox::yview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "yview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Listbox& Listbox::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
@@ -2537,7 +5105,7 @@ Listbox& Listbox::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -2549,20 +5117,18 @@ Listbox& Listbox::selectmode(const std::string& mode)
 
 Listbox& Listbox::see(const std::string& index)
 {
-    call({impl_->full_name, "see", index});
+    exec({impl_->full_name, "see", index});
     return *this;
 }
 
 int Listbox::nearest(int y) const
 {
-    auto ret = call({impl_->full_name, "nearest", y});
-    return safe_stol(ret.c_str());
+    return call_int({impl_->full_name, "nearest", y});
 }
 
 int Listbox::size() const
 {
-    auto ret = call({impl_->full_name, "size"});
-    return safe_stol(ret.c_str());
+    return call_int({impl_->full_name, "size"});
 }
 
 Listbox& Listbox::select_set(const std::string& first, const std::string& last)
@@ -2570,7 +5136,7 @@ Listbox& Listbox::select_set(const std::string& first, const std::string& last)
     std::vector<ArgValue> words = {impl_->full_name, "selection", "set", first};
     if (!last.empty())
         words.push_back(last);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -2579,137 +5145,121 @@ Listbox& Listbox::select_clear(const std::string& first, const std::string& last
     std::vector<ArgValue> words = {impl_->full_name, "selection", "clear", first};
     if (!last.empty())
         words.push_back(last);
-    call(words);
+    exec(words);
     return *this;
 }
 
 bool Listbox::select_includes(const std::string& index) const
 {
-    auto ret = call({impl_->full_name, "selection", "includes", index});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "selection", "includes", index});
 }
 
 Listbox& Listbox::activate(const std::string& index)
 {
-    call({impl_->full_name, "activate", index});
+    exec({impl_->full_name, "activate", index});
     return *this;
 }
 
-Menu::Menu(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Menu::Menu(const Widget& parent, const Options& options)
     : Widget(parent, "menu", "menu", options)
 {
 }
 
-Menu& Menu::add_command(const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+// 項目の"-command"を読む。セパレータ等"-command"を持たない項目や無効なindexでも報告しないよう、
+// entrycgetはInterpreterで直接評価し、失敗したら空を返す(catchのラムダを毎回コンパイルさせない)。
+static std::string menu_entry_command(Interpreter& p, const Menu& menu, const std::string& index)
+{
+    if (!p.eval({menu.full_name(), "entrycget", index, "-command"}))
+        return std::string();
+    return p.result_string();
+}
+
+Menu& Menu::add_command(const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", "command"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     if (callback)
     {
-        auto cb_name = next_menu_entry_callback_name(impl_->full_name);
-        register_void_callback(cb_name, callback);
+        auto cb_name = register_void_callback("", callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Menu& Menu::add_cascade(const std::map<std::string, ArgValue>& options)
+Menu& Menu::add_cascade(const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", "cascade"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Menu& Menu::add_separator()
 {
-    call({impl_->full_name, "add", "separator"});
+    exec({impl_->full_name, "add", "separator"});
     return *this;
 }
 
-Menu& Menu::add_checkbutton(const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+Menu& Menu::add_checkbutton(const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", "checkbutton"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     if (callback)
     {
-        auto cb_name = next_menu_entry_callback_name(impl_->full_name);
-        register_void_callback(cb_name, callback);
+        auto cb_name = register_void_callback("", callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Menu& Menu::add_radiobutton(const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+Menu& Menu::add_radiobutton(const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", "radiobutton"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     if (callback)
     {
-        auto cb_name = next_menu_entry_callback_name(impl_->full_name);
-        register_void_callback(cb_name, callback);
+        auto cb_name = register_void_callback("", callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Menu& Menu::insert(const std::string& index, const std::string& item_type, const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+Menu& Menu::insert(const std::string& index, const std::string& item_type, const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "insert", index, item_type};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     if (callback)
     {
-        auto cb_name = next_menu_entry_callback_name(impl_->full_name);
-        register_void_callback(cb_name, callback);
+        auto cb_name = register_void_callback("", callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Menu& Menu::entryconfigure(const std::string& index, const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+Menu& Menu::entryconfigure(const std::string& index, const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "entryconfigure", index};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    if (callback)
+    options.append_to(words);
+    std::string previous;
+    auto* p = checked_interp("entryconfigure");
+    if (callback && p)
     {
-        auto cb_name = next_menu_entry_callback_name(impl_->full_name);
-        register_void_callback(cb_name, callback);
+        previous = menu_entry_command(*p, *this, index);
+        auto cb_name = register_void_callback("", callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
+    if (!previous.empty() && p)
+        p->release_callback_command(impl_->full_name, previous);
     return *this;
 }
 
@@ -2727,19 +5277,24 @@ int Menu::index(const std::string& pattern) const
 
 Menu& Menu::erase(const std::string& index)
 {
-    call({impl_->full_name, "delete", index});
+    // 項目の"-command"がadd_command()等で登録したコールバックなら、項目と一緒に削除する。
+    auto* p = checked_interp("erase");
+    auto command = p ? menu_entry_command(*p, *this, index) : std::string();
+    exec({impl_->full_name, "delete", index});
+    if (!command.empty() && p)
+        p->release_callback_command(impl_->full_name, command);
     return *this;
 }
 
 Menu& Menu::post(int x, int y)
 {
-    call({impl_->full_name, "post", x, y});
+    exec({impl_->full_name, "post", x, y});
     return *this;
 }
 
 Menu& Menu::unpost()
 {
-    call({impl_->full_name, "unpost"});
+    exec({impl_->full_name, "unpost"});
     return *this;
 }
 
@@ -2761,10 +5316,9 @@ OptionMenu::OptionMenu(const Widget& parent, StringVar& variable, const std::vec
     for (std::size_t i = 0; i < values.size(); ++i)
     {
         std::string value = values[i];
-        auto cb_name = sanitize(full_name()) + "_optmenu_cb_" + std::to_string(i);
         auto* var_ptr = &variable;
         auto cmd = command_;
-        register_void_callback(cb_name, [var_ptr, value, cmd]() {
+        auto cb_name = register_void_callback("", [var_ptr, value, cmd]() {
             var_ptr->set(value);
             if (*cmd) (*cmd)(value);
         });
@@ -2801,25 +5355,21 @@ PanedWindow& PanedWindow::orient(const std::string& dir)
     return *this;
 }
 
-PanedWindow& PanedWindow::add(const Widget& child, const std::map<std::string, ArgValue>& options)
+PanedWindow& PanedWindow::add(const Widget& child, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", child.full_name()};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 PanedWindow& PanedWindow::forget(const Widget& child)
 {
-    call({impl_->full_name, "forget", child.full_name()});
+    exec({impl_->full_name, "forget", child.full_name()});
     return *this;
 }
 
-Radiobutton::Radiobutton(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Radiobutton::Radiobutton(const Widget& parent, const Options& options)
     : Widget(parent, "radiobutton", "rb", options)
 {
 }
@@ -2838,14 +5388,13 @@ Radiobutton& Radiobutton::variable(Var& var)
 
 Radiobutton& Radiobutton::value(const std::string& val)
 {
-    call({impl_->full_name, "configure", "-value", val});
+    exec({impl_->full_name, "configure", "-value", val});
     return *this;
 }
 
 Radiobutton& Radiobutton::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_rb_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
@@ -2855,7 +5404,7 @@ std::string Radiobutton::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Scale::Scale(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Scale::Scale(const Widget& parent, const Options& options)
     : Widget(parent, "scale", "scale", options)
 {
 }
@@ -2880,25 +5429,23 @@ Scale& Scale::orient(const std::string& dir)
 
 Scale& Scale::command(std::function<void(const double&)> callback)
 {
-    std::string callback_name = sanitize(full_name()) + "_double_cb";
-    register_double_callback(callback_name, callback);
+    auto callback_name = register_double_callback("command", callback);
     config({{"command", callback_name}});
     return *this;
 }
 
 double Scale::get() const
 {
-    auto ret = call({impl_->full_name, "get"});
-    return safe_stod(ret.c_str());
+    return call_double({impl_->full_name, "get"});
 }
 
 Scale& Scale::set(double value)
 {
-    call({impl_->full_name, "set", value});
+    exec({impl_->full_name, "set", value});
     return *this;
 }
 
-Scrollbar::Scrollbar(const Widget& parent, const std::map<std::string, ArgValue>& options) 
+Scrollbar::Scrollbar(const Widget& parent, const Options& options) 
     : Widget(parent, "scrollbar", "scrollbar", options)
 {
 }
@@ -2911,8 +5458,7 @@ Scrollbar& Scrollbar::orient(const std::string& dir)
 
 Scrollbar& Scrollbar::command(std::function<void(const std::string&)> callback) 
 {
-    std::string callback_name = sanitize(full_name()) + "_scroll_cb";
-    register_string_callback(callback_name, callback);
+    auto callback_name = register_string_callback("command", callback);
     config({{"command", callback_name}});
     return *this;
 }
@@ -2922,11 +5468,11 @@ Scrollbar& Scrollbar::set(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "set"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
-Spinbox::Spinbox(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Spinbox::Spinbox(const Widget& parent, const Options& options)
     : Widget(parent, "spinbox", "spinbox", options)
 {
 }
@@ -2962,20 +5508,24 @@ Spinbox& Spinbox::textvariable(StringVar& var)
 
 Spinbox& Spinbox::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_sp_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
 
-Text::Text(const Widget& parent, const std::map<std::string, ArgValue>& options) 
+Text::Text(const Widget& parent, const Options& options) 
     : Widget(parent, "text", "text", options)
 {
 }
 
 Text& Text::insert(const std::string& index, const std::string& text) 
 {
-    call({impl_->full_name, "insert", index, text});
+    return insert(index, StringRef(text));
+}
+
+Text& Text::insert(const std::string& index, const StringRef& text)
+{
+    exec_direct({impl_->full_name, "insert", index, text});
     return *this;
 }
 
@@ -2986,14 +5536,13 @@ std::string Text::get(const std::string& start, const std::string& end) const
 
 Text& Text::erase(const std::string& start, const std::string& end) 
 {
-    call({impl_->full_name, "delete", start, end});
+    exec({impl_->full_name, "delete", start, end});
     return *this;
 }
 
 Text& Text::yscrollcommand(std::function<void(std::string)> callback) 
 {
-    auto cb_name = sanitize(full_name()) + "_string_cb";
-    register_string_callback(cb_name, callback);        
+    auto cb_name = register_string_callback("yscrollcommand", callback);        
     config({{"yscrollcommand", cb_name}});
     return *this;
 }
@@ -3003,14 +5552,13 @@ Text& Text::yview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "yview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Text& Text::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
@@ -3020,22 +5568,15 @@ Text& Text::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 std::vector<int> Text::bbox(const std::string& index) const
 {
-    auto ok     = false;
-    auto result = call({impl_->full_name, "bbox", index}, &ok);
-
-    std::vector<int> box;
-    if (!ok)
-        return box;
-
-    for (const auto& token : impl_->interp->split_list(result))
-        box.push_back(safe_stol(token.c_str()));
-    return box;
+    // 失敗時は例外を投げず空を返す(call_int_list()は失敗時に空を返す)。
+    auto ok = false;
+    return call_int_list({impl_->full_name, "bbox", index}, &ok);
 }
 
 Text& Text::wrap(const std::string& mode)
@@ -3046,48 +5587,40 @@ Text& Text::wrap(const std::string& mode)
 
 Text& Text::tag_add(const std::string& tag, const std::string& start, const std::string& end)
 {
-    call({impl_->full_name, "tag", "add", tag, start, end});
+    exec({impl_->full_name, "tag", "add", tag, start, end});
     return *this;
 }
 
 Text& Text::tag_remove(const std::string& tag, const std::string& start, const std::string& end)
 {
-    call({impl_->full_name, "tag", "remove", tag, start, end});
+    exec({impl_->full_name, "tag", "remove", tag, start, end});
     return *this;
 }
 
-Text& Text::tag_config(const std::string& tag, const std::map<std::string, ArgValue>& options)
+Text& Text::tag_config(const std::string& tag, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "tag", "configure", tag};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Text& Text::mark_set(const std::string& mark, const std::string& index)
 {
-    call({impl_->full_name, "mark", "set", mark, index});
+    exec({impl_->full_name, "mark", "set", mark, index});
     return *this;
 }
 
 Text& Text::mark_unset(const std::string& mark)
 {
-    call({impl_->full_name, "mark", "unset", mark});
+    exec({impl_->full_name, "mark", "unset", mark});
     return *this;
 }
 
-std::string Text::search(const std::string& pattern, const std::string& index, const std::map<std::string, ArgValue>& options)
+std::string Text::search(const std::string& pattern, const std::string& index, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "search"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     words.push_back(pattern);
     words.push_back(index);
     auto ok  = false;
@@ -3097,7 +5630,7 @@ std::string Text::search(const std::string& pattern, const std::string& index, c
 
 Text& Text::see(const std::string& index)
 {
-    call({impl_->full_name, "see", index});
+    exec({impl_->full_name, "see", index});
     return *this;
 }
 
@@ -3111,14 +5644,12 @@ std::vector<std::string> Text::tag_names(const std::string& index) const
     std::vector<ArgValue> words = {impl_->full_name, "tag", "names"};
     if (!index.empty())
         words.push_back(index);
-    auto ret = call(words);
-    return impl_->interp->split_list(ret);
+    return call_list(words);
 }
 
 std::vector<std::string> Text::tag_ranges(const std::string& tag) const
 {
-    auto ret = call({impl_->full_name, "tag", "ranges", tag});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "tag", "ranges", tag});
 }
 
 Text& Text::tag_raise(const std::string& tag, const std::string& above_this)
@@ -3126,7 +5657,7 @@ Text& Text::tag_raise(const std::string& tag, const std::string& above_this)
     std::vector<ArgValue> words = {impl_->full_name, "tag", "raise", tag};
     if (!above_this.empty())
         words.push_back(above_this);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -3135,13 +5666,13 @@ Text& Text::tag_lower(const std::string& tag, const std::string& below_this)
     std::vector<ArgValue> words = {impl_->full_name, "tag", "lower", tag};
     if (!below_this.empty())
         words.push_back(below_this);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Text& Text::tag_delete(const std::string& tag)
 {
-    call({impl_->full_name, "tag", "delete", tag});
+    exec({impl_->full_name, "tag", "delete", tag});
     return *this;
 }
 
@@ -3161,26 +5692,23 @@ Text& Text::edit_redo()
 
 bool Text::edit_modified() const
 {
-    auto ret = call({impl_->full_name, "edit", "modified"});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "edit", "modified"});
 }
 
 Text& Text::edit_modified(bool value)
 {
-    call({impl_->full_name, "edit", "modified", value});
+    exec({impl_->full_name, "edit", "modified", value});
     return *this;
 }
 
 bool Text::compare(const std::string& index1, const std::string& op, const std::string& index2) const
 {
-    auto ret = call({impl_->full_name, "compare", index1, op, index2});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "compare", index1, op, index2});
 }
 
 int Text::count(const std::string& index1, const std::string& index2, const std::string& option) const
 {
-    auto ret = call({impl_->full_name, "count", "-" + option, index1, index2});
-    return safe_stol(ret.c_str());
+    return call_int({impl_->full_name, "count", "-" + option, index1, index2});
 }
 
 std::string Text::dump(const std::string& index1, const std::string& index2) const
@@ -3191,39 +5719,31 @@ std::string Text::dump(const std::string& index1, const std::string& index2) con
     return call(words);
 }
 
-std::string Text::image_create(const std::string& index, const std::map<std::string, ArgValue>& options)
+std::string Text::image_create(const std::string& index, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "image", "create", index};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     return call(words);
 }
 
-Text& Text::window_create(const std::string& index, const Widget& window, const std::map<std::string, ArgValue>& options)
+Text& Text::window_create(const std::string& index, const Widget& window, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "window", "create", index, "-window", window.full_name()};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 namespace font
 {
 
-Font::Font(const std::map<std::string, ArgValue>& option, const std::string& name, bool exists)
+Font::Font(const Options& option, const std::string& name, bool exists)
     : interp_(current_interp())
 {
     name_ = name.empty() ? ("font_" + id) : name;
     if (!exists)
     {
-        call({"font", "create", name_});
+        exec_now({"font", "create", name_});
     }
     if (!option.empty())
     {
@@ -3236,15 +5756,11 @@ Font nametofont(const std::string& name)
     return Font({}, name, /*exists=*/true);
 }
 
-Font& Font::config(const std::map<std::string, ArgValue>& option)
+Font& Font::config(const Options& option)
 {
     std::vector<ArgValue> words = {"font", "configure", name_};
-    for (const auto &kv : option)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    option.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -3300,7 +5816,7 @@ Font Font::copy() const
     std::vector<ArgValue> words = {"font", "configure", result.name_};
     for (const auto& token : tokens)
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return result;
 }
 
@@ -3308,24 +5824,29 @@ std::vector<std::string> families()
 {
     auto* interp = current_interp();
     bool ok = false;
-    auto ret = interp->call({"font", "families"}, &ok);
-    if (!ok) return {};
-    return interp->split_list(ret);
+    if (!interp->eval({"font", "families"}))
+    {
+        report_tcl_failure(*interp, "families", &ok);
+        return {};
+    }
+    return interp->result_list();
 }
 
 std::vector<std::string> names()
 {
     auto* interp = current_interp();
     bool ok = false;
-    auto ret = interp->call({"font", "names"}, &ok);
-    if (!ok) return {};
-    return interp->split_list(ret);
+    if (!interp->eval({"font", "names"}))
+    {
+        report_tcl_failure(*interp, "names", &ok);
+        return {};
+    }
+    return interp->result_list();
 }
 
 int Font::measure(const std::string& text) const
 {
-    auto ret = call({"font", "measure", name_, text});
-    return safe_stol(ret.c_str());
+    return call_int({"font", "measure", name_, text});
 }
 
 const std::string& Font::name() const
@@ -3342,15 +5863,11 @@ Style::Style()
     : interp_(current_interp())
 {}
 
-Style& Style::configure(const std::string& style_name, const std::map<std::string, ArgValue>& options)
+Style& Style::configure(const std::string& style_name, const Options& options)
 {
     std::vector<ArgValue> words = {"ttk::style", "configure", style_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -3362,7 +5879,7 @@ Style& Style::map(const std::string& style_name, const std::map<std::string, std
         words.push_back("-" + kv.first);
         words.push_back(std::vector<ArgValue>(kv.second.begin(), kv.second.end()));
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -3373,13 +5890,13 @@ std::string Style::lookup(const std::string& style_name, const std::string& opti
 
 std::vector<std::string> Style::theme_names() const
 {
-    return interp_->split_list(call({"ttk::style", "theme", "names"}));
+    return call_list({"ttk::style", "theme", "names"});
 }
 
 Style& Style::theme_use(const std::string& theme_name)
 {
     // Python本家もttk::styleではなくttk::setThemeを使う($ttk::currentThemeの追従のため)
-    call({"ttk::setTheme", theme_name});
+    exec({"ttk::setTheme", theme_name});
     return *this;
 }
 
@@ -3395,7 +5912,7 @@ std::string Style::layout(const std::string& style_name) const
 
 Style& Style::layout(const std::string& style_name, const std::string& layout_spec)
 {
-    call({"ttk::style", "layout", style_name, layout_spec});
+    exec({"ttk::style", "layout", style_name, layout_spec});
     return *this;
 }
 
@@ -3404,7 +5921,7 @@ Style& Style::element_create(const std::string& name, const std::string& type, c
     std::vector<ArgValue> words = {"ttk::style", "element", "create", name, type};
     for (const auto& arg : args)
         words.push_back(arg);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -3421,11 +5938,11 @@ Style& Style::theme_create(const std::string& name, const std::string& parent, c
         words.push_back("-settings");
         words.push_back(settings_script);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Button::Button(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Button::Button(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::button", "ttk_b", options)
 {
 }
@@ -3450,8 +5967,7 @@ Button& Button::text(const std::string& text)
 
 Button& Button::command(std::function<void()> callback)
 {
-    std::string callback_name =  sanitize(full_name()) + "_void_callback";
-    register_void_callback(callback_name, callback);
+    auto callback_name = register_void_callback("command", callback);
     config({{"command", callback_name}});        
     return *this;
 }
@@ -3467,7 +5983,7 @@ std::string Button::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Checkbutton::Checkbutton(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Checkbutton::Checkbutton(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::checkbutton", "ttk_checkbutton", options)
 {
 }
@@ -3486,8 +6002,7 @@ Checkbutton& Checkbutton::variable(Var& var)
 
 Checkbutton& Checkbutton::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_chk_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
@@ -3497,7 +6012,7 @@ std::string Checkbutton::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Combobox::Combobox(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Combobox::Combobox(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::combobox", "ttk_combobox", options)
 {
 }
@@ -3548,13 +6063,13 @@ Combobox& Combobox::font(const font::Font& font)
 
 Combobox& Combobox::set(const std::string& value)
 {
-    call({impl_->full_name, "set", value});
+    exec({impl_->full_name, "set", value});
     return *this;
 }
 
 Combobox& Combobox::insert(const std::string& index, const std::string& text) 
 {
-    call({impl_->full_name, "insert", index, text});
+    exec({impl_->full_name, "insert", index, text});
     return *this;
 }
 
@@ -3565,23 +6080,22 @@ std::string Combobox::get() const
 
 Combobox& Combobox::erase(const std::string& start, const std::string& end) 
 {
-    call({impl_->full_name, "delete", start, end});
+    exec({impl_->full_name, "delete", start, end});
     return *this;
 }
 
 int Combobox::current() const
 {
-    const auto val = call({impl_->full_name, "current"});
-    return safe_stol(val.c_str());
+    return call_int({impl_->full_name, "current"});
 }
 
 Combobox& Combobox::current(const int& idx)
 {
-    call({impl_->full_name, "current", idx});
+    exec({impl_->full_name, "current", idx});
     return *this;    
 }
 
-Entry::Entry(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Entry::Entry(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::entry", "ttk_entry", options)
 {
 }
@@ -3600,13 +6114,13 @@ Entry& Entry::state(const std::string& state)
 
 Entry& Entry::icursor(const std::string& index)
 {
-    call({impl_->full_name, "icursor", index});
+    exec({impl_->full_name, "icursor", index});
     return *this;
 }
 
 Entry& Entry::insert(const std::string& index, const std::string& text) 
 {
-    call({impl_->full_name, "insert", index, text});
+    exec({impl_->full_name, "insert", index, text});
     return *this;
 }
 
@@ -3624,7 +6138,7 @@ Entry& Entry::erase(const std::string& start, const std::string& end)
     std::vector<ArgValue> words = {impl_->full_name, "delete", start};
     if (!end.empty())
         words.push_back(end);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -3637,8 +6151,7 @@ std::string Entry::get() const
 
 Entry& Entry::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
@@ -3648,37 +6161,35 @@ Entry& Entry::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Entry& Entry::select_range(const std::string& start, const std::string& end)
 {
-    call({impl_->full_name, "selection", "range", start, end});
+    exec({impl_->full_name, "selection", "range", start, end});
     return *this;
 }
 
 Entry& Entry::selection_clear()
 {
-    call({impl_->full_name, "selection", "clear"});
+    exec({impl_->full_name, "selection", "clear"});
     return *this;
 }
 
 bool Entry::select_present() const
 {
-    auto ret = call({impl_->full_name, "selection", "present"});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "selection", "present"});
 }
 
 Entry& Entry::validate(const std::string& mode, std::function<bool(const std::string&)> callback)
 {
-    auto cb_name = sanitize(full_name()) + "_validate_cb";
-    register_bool_callback(cb_name, callback);
+    auto cb_name = register_bool_callback("validatecommand", callback);
     config({{"validate", mode}, {"validatecommand", cb_name + " %P"}});
     return *this;
 }
 
-Frame::Frame(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Frame::Frame(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::frame", "ttk_frame", options)
 {
 }
@@ -3696,7 +6207,7 @@ Frame& Frame::height(const int &height)
 }
 
 
-Label::Label(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Label::Label(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::label", "tl", options)
 {
 }
@@ -3725,7 +6236,7 @@ Label& Label::font(const font::Font& font)
     return *this;
 }
 
-Labelframe::Labelframe(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Labelframe::Labelframe(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::labelframe", "ttk_labelframe", options)
 {
 }
@@ -3736,7 +6247,7 @@ Labelframe& Labelframe::text(const std::string& text)
     return *this;
 }
 
-Menubutton::Menubutton(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Menubutton::Menubutton(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::menubutton", "ttk_menubutton", options)
 {
 }
@@ -3747,20 +6258,20 @@ Menubutton& Menubutton::menu(Menu* menu)
     return *this;
 }
 
-Notebook::Notebook(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Notebook::Notebook(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::notebook", "ttk_notebook", options)
 {
 }
 
 Notebook& Notebook::add_tab(const Widget& child, const std::string& label) 
 {
-    call({impl_->full_name, "add", child.full_name(), "-text", label});
+    exec({impl_->full_name, "add", child.full_name(), "-text", label});
     return *this;
 }
 
 Notebook& Notebook::select(const std::string& tab_id)
 {
-    call({impl_->full_name, "select", tab_id});
+    exec({impl_->full_name, "select", tab_id});
     return *this;
 }
 
@@ -3769,15 +6280,11 @@ std::string Notebook::select() const
     return call({impl_->full_name, "select"});
 }
 
-Notebook& Notebook::tab(const std::string& tab_id, const std::map<std::string, ArgValue>& options)
+Notebook& Notebook::tab(const std::string& tab_id, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "tab", tab_id};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
@@ -3788,29 +6295,27 @@ std::string Notebook::tab(const std::string& tab_id, const std::string& option)
 
 std::vector<std::string> Notebook::tabs() const
 {
-    auto ret = call({impl_->full_name, "tabs"});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "tabs"});
 }
 
 Notebook& Notebook::forget(const std::string& tab_id)
 {
-    call({impl_->full_name, "forget", tab_id});
+    exec({impl_->full_name, "forget", tab_id});
     return *this;
 }
 
 Notebook& Notebook::hide(const std::string& tab_id)
 {
-    call({impl_->full_name, "hide", tab_id});
+    exec({impl_->full_name, "hide", tab_id});
     return *this;
 }
 
 int Notebook::index(const std::string& tab_id) const
 {
-    auto ret = call({impl_->full_name, "index", tab_id});
-    return safe_stol(ret.c_str());
+    return call_int({impl_->full_name, "index", tab_id});
 }
 
-PanedWindow::PanedWindow(const Widget& parent, const std::map<std::string, ArgValue>& options)
+PanedWindow::PanedWindow(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::panedwindow", "ttk_panedwindow", options)
 {
 }
@@ -3821,43 +6326,37 @@ PanedWindow& PanedWindow::orient(const std::string& dir)
     return *this;
 }
 
-PanedWindow& PanedWindow::add(const Widget& child, const std::map<std::string, ArgValue>& options)
+PanedWindow& PanedWindow::add(const Widget& child, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "add", child.full_name()};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 PanedWindow& PanedWindow::forget(const Widget& child)
 {
-    call({impl_->full_name, "forget", child.full_name()});
+    exec({impl_->full_name, "forget", child.full_name()});
     return *this;
 }
 
 int PanedWindow::sashpos(int index) const
 {
-    auto ret = call({impl_->full_name, "sashpos", index});
-    return safe_stol(ret.c_str());
+    return call_int({impl_->full_name, "sashpos", index});
 }
 
 PanedWindow& PanedWindow::sashpos(int index, int newpos)
 {
-    call({impl_->full_name, "sashpos", index, newpos});
+    exec({impl_->full_name, "sashpos", index, newpos});
     return *this;
 }
 
 std::vector<std::string> PanedWindow::panes() const
 {
-    auto ret = call({impl_->full_name, "panes"});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "panes"});
 }
 
-Progressbar::Progressbar(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Progressbar::Progressbar(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::progressbar", "ttk_progress", options)
 {
 }
@@ -3876,23 +6375,23 @@ Progressbar& Progressbar::value(double v)
 
 Progressbar& Progressbar::start(int interval)
 {
-    call({impl_->full_name, "start", interval});
+    exec({impl_->full_name, "start", interval});
     return *this;
 }
 
 Progressbar& Progressbar::stop()
 {
-    call({impl_->full_name, "stop"});
+    exec({impl_->full_name, "stop"});
     return *this;
 }
 
 Progressbar& Progressbar::step(double amount)
 {
-    call({impl_->full_name, "step", amount});
+    exec({impl_->full_name, "step", amount});
     return *this;
 }
 
-Radiobutton::Radiobutton(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Radiobutton::Radiobutton(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::radiobutton", "ttk_radiobutton", options)
 {
 }
@@ -3911,14 +6410,13 @@ Radiobutton& Radiobutton::variable(Var& var)
 
 Radiobutton& Radiobutton::value(const std::string& val)
 {
-    call({impl_->full_name, "configure", "-value", val});
+    exec({impl_->full_name, "configure", "-value", val});
     return *this;
 }
 
 Radiobutton& Radiobutton::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_rb_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
@@ -3928,11 +6426,11 @@ std::string Radiobutton::invoke()
     return Widget::call({impl_->full_name, "invoke"});
 }
 
-Separator::Separator(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Separator::Separator(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::separator", "ttk_separator", options)
 {}
 
-Scale::Scale(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Scale::Scale(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::scale", "ttk_scale", options)
 {
 }
@@ -3957,25 +6455,23 @@ Scale& Scale::orient(const std::string& dir)
 
 Scale& Scale::command(std::function<void(const double&)> callback)
 {
-    std::string callback_name = sanitize(full_name()) + "_double_cb";
-    register_double_callback(callback_name, callback);
+    auto callback_name = register_double_callback("command", callback);
     config({{"command", callback_name}});
     return *this;
 }
 
 double Scale::get() const
 {
-    auto ret = call({impl_->full_name, "get"});
-    return safe_stod(ret.c_str());
+    return call_double({impl_->full_name, "get"});
 }
 
 Scale& Scale::set(double value)
 {
-    call({impl_->full_name, "set", value});
+    exec({impl_->full_name, "set", value});
     return *this;
 }
 
-Scrollbar::Scrollbar(const Widget& parent, const std::map<std::string, ArgValue>& options) 
+Scrollbar::Scrollbar(const Widget& parent, const Options& options) 
     : Widget(parent, "ttk::scrollbar", "ttk_scrollbar", options)
 {
 }
@@ -3988,8 +6484,7 @@ Scrollbar& Scrollbar::orient(const std::string& dir)
 
 Scrollbar& Scrollbar::command(std::function<void(const std::string&)> callback) 
 {
-    std::string callback_name = sanitize(full_name()) + "_scroll_cb";
-    register_string_callback(callback_name, callback);
+    auto callback_name = register_string_callback("command", callback);
     config({{"command", callback_name}});
     return *this;
 }
@@ -3999,11 +6494,11 @@ Scrollbar& Scrollbar::set(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "set"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
-Spinbox::Spinbox(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Spinbox::Spinbox(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::spinbox", "ttk_spinbox", options)
 {
 }
@@ -4039,96 +6534,78 @@ Spinbox& Spinbox::textvariable(StringVar& var)
 
 Spinbox& Spinbox::command(std::function<void()> callback)
 {
-    auto cb = sanitize(full_name()) + "_sp_cb";
-    register_void_callback(cb, callback);
+    auto cb = register_void_callback("command", callback);
     config({{"command", cb}});
     return *this;
 }
 
-Sizegrip::Sizegrip(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Sizegrip::Sizegrip(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::sizegrip", "ttk_sizegrip", options)
 {
 }
 
-Treeview::Treeview(const Widget& parent, const std::map<std::string, ArgValue>& options)
+Treeview::Treeview(const Widget& parent, const Options& options)
     : Widget(parent, "ttk::treeview", "tv", options)
 {
 }
 
-Treeview& Treeview::insert(const std::string& parent, const std::string& index, const std::string& iid, const std::map<std::string, ArgValue>& options)
+Treeview& Treeview::insert(const std::string& parent, const std::string& index, const std::string& iid, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "insert", parent, index, "-id", iid};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 Treeview& Treeview::erase(const std::string& iid)
 {
-    call({impl_->full_name, "delete", iid});
+    exec({impl_->full_name, "delete", iid});
     return *this;
 }
 
-Treeview& Treeview::item(const std::string& iid, const std::map<std::string, ArgValue>& options)
+Treeview& Treeview::item(const std::string& iid, const Options& options)
 {
     if (options.empty())
     {
         // getter 的な使い方をしたい場合は、必要に応じて別メソッドを追加してもよい
-        call({impl_->full_name, "item", iid});
+        exec({impl_->full_name, "item", iid});
         return *this;
     }
 
     std::vector<ArgValue> words = {impl_->full_name, "item", iid};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
-Treeview& Treeview::heading(const std::string& column, const std::map<std::string, ArgValue>& options, std::function<void()> callback)
+Treeview& Treeview::heading(const std::string& column, const Options& options, std::function<void()> callback)
 {
     std::vector<ArgValue> words = {impl_->full_name, "heading", column};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     if (callback)
     {
-        // 列名(column)はindexと違い挿入/削除で変動しない安定した識別子のため、
-        // Menuの項目コールバックと異なりfull_name+columnから決定的に名前を生成できる。
-        auto cb_name = sanitize(impl_->full_name) + "_heading_" + sanitize(column) + "_cb";
-        register_void_callback(cb_name, callback);
+        // 列名(column)はindexと違い挿入/削除で変動しないため、"heading "+columnをroleとして登録する。
+        // コマンド名は整数トークン(cpp_tk_cb<N>)で、同じ列に再設定すると前のコールバックは削除されて置き換わる
+        // (Menuの項目コールバックのようにroleなしで登録して個別に解放する必要はない)。
+        auto cb_name = register_void_callback("heading " + column, callback);
         words.push_back("-command");
         words.push_back(cb_name);
     }
-    call(words);
+    exec(words);
     return *this;
 }
 
-Treeview& Treeview::column(const std::string& column, const std::map<std::string, ArgValue>& options)
+Treeview& Treeview::column(const std::string& column, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "column", column};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
 std::vector<std::string> Treeview::selection() const
 {
-    auto ret = call({impl_->full_name, "selection"});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "selection"});
 }
 
 // Tclの"ttk::treeview selection set/add/remove/toggle"はitemsを「1個のTclリスト引数」として
@@ -4137,37 +6614,36 @@ std::vector<std::string> Treeview::selection() const
 // ArgValue(vector<ArgValue>)のLIST(Tcl_NewListObj経由で各要素を正しくquoteする)を使う。
 Treeview& Treeview::selection_set(const std::vector<std::string>& iids)
 {
-    call({impl_->full_name, "selection", "set", std::vector<ArgValue>(iids.begin(), iids.end())});
+    exec({impl_->full_name, "selection", "set", std::vector<ArgValue>(iids.begin(), iids.end())});
     return *this;
 }
 
 Treeview& Treeview::selection_add(const std::vector<std::string>& iids)
 {
-    call({impl_->full_name, "selection", "add", std::vector<ArgValue>(iids.begin(), iids.end())});
+    exec({impl_->full_name, "selection", "add", std::vector<ArgValue>(iids.begin(), iids.end())});
     return *this;
 }
 
 Treeview& Treeview::selection_remove(const std::vector<std::string>& iids)
 {
-    call({impl_->full_name, "selection", "remove", std::vector<ArgValue>(iids.begin(), iids.end())});
+    exec({impl_->full_name, "selection", "remove", std::vector<ArgValue>(iids.begin(), iids.end())});
     return *this;
 }
 
 Treeview& Treeview::selection_toggle(const std::vector<std::string>& iids)
 {
-    call({impl_->full_name, "selection", "toggle", std::vector<ArgValue>(iids.begin(), iids.end())});
+    exec({impl_->full_name, "selection", "toggle", std::vector<ArgValue>(iids.begin(), iids.end())});
     return *this;
 }
 
 bool Treeview::exists(const std::string& iid) const
 {
-    auto ret = call({impl_->full_name, "exists", iid});
-    return safe_stol(ret.c_str()) != 0;
+    return call_bool({impl_->full_name, "exists", iid});
 }
 
 Treeview& Treeview::see(const std::string& iid)
 {
-    call({impl_->full_name, "see", iid});
+    exec({impl_->full_name, "see", iid});
     return *this;
 }
 
@@ -4176,7 +6652,7 @@ Treeview& Treeview::xview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "xview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
@@ -4185,29 +6661,27 @@ Treeview& Treeview::yview(const std::string& args)
     std::vector<ArgValue> words = {impl_->full_name, "yview"};
     for (const auto& token : impl_->interp->split_list(args))
         words.emplace_back(token);
-    call(words);
+    exec(words);
     return *this;
 }
 
 Treeview& Treeview::xscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(impl_->full_name) + "_xstring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("xscrollcommand", callback);
     config({{"xscrollcommand", cb_name}});
     return *this;
 }
 
 Treeview& Treeview::yscrollcommand(std::function<void(std::string)> callback)
 {
-    auto cb_name = sanitize(impl_->full_name) + "_ystring_cb";
-    register_string_callback(cb_name, callback);
+    auto cb_name = register_string_callback("yscrollcommand", callback);
     config({{"yscrollcommand", cb_name}});
     return *this;
 }
 
 Treeview& Treeview::set(const std::string& iid, const std::string& column, const ArgValue& value)
 {
-    call({impl_->full_name, "set", iid, column, value});
+    exec({impl_->full_name, "set", iid, column, value});
     return *this;
 }
 
@@ -4218,26 +6692,25 @@ std::string Treeview::set(const std::string& iid, const std::string& column) con
 
 Treeview& Treeview::move(const std::string& iid, const std::string& parent, const std::string& index)
 {
-    call({impl_->full_name, "move", iid, parent, index});
+    exec({impl_->full_name, "move", iid, parent, index});
     return *this;
 }
 
 Treeview& Treeview::detach(const std::string& iid)
 {
-    call({impl_->full_name, "detach", iid});
+    exec({impl_->full_name, "detach", iid});
     return *this;
 }
 
 Treeview& Treeview::reattach(const std::string& iid, const std::string& parent, const std::string& index)
 {
-    call({impl_->full_name, "reattach", iid, parent, index});
+    exec({impl_->full_name, "reattach", iid, parent, index});
     return *this;
 }
 
 std::vector<std::string> Treeview::get_children(const std::string& iid) const
 {
-    auto ret = call({impl_->full_name, "children", iid});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "children", iid});
 }
 
 std::string Treeview::parent(const std::string& iid) const
@@ -4253,7 +6726,7 @@ int Treeview::index(const std::string& iid) const
 
 Treeview& Treeview::focus(const std::string& iid)
 {
-    call({impl_->full_name, "focus", iid});
+    exec({impl_->full_name, "focus", iid});
     return *this;
 }
 
@@ -4262,34 +6735,25 @@ std::string Treeview::focus() const
     return call({impl_->full_name, "focus"});
 }
 
-Treeview& Treeview::tag_configure(const std::string& tag, const std::map<std::string, ArgValue>& options)
+Treeview& Treeview::tag_configure(const std::string& tag, const Options& options)
 {
     std::vector<ArgValue> words = {impl_->full_name, "tag", "configure", tag};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    call(words);
+    options.append_to(words);
+    exec(words);
     return *this;
 }
 
-Treeview& Treeview::tag_bind(const std::string& tag, const std::string& event, std::function<void(const Event&)> callback)
+Treeview& Treeview::tag_bind(const std::string& tag, const std::string& event, std::function<void(const Event&)> callback, EventField fields, Coalesce coalesce)
 {
-    auto cb_name = sanitize(full_name()) + "_tag_" + sanitize(tag) + "_" + sanitize(event);
+    auto cb_name = register_event_callback("tag " + tag + " " + event, callback, fields, coalesce);
 
-    register_event_callback(cb_name, callback);
-
-    std::string script = cb_name + " %x %y %X %Y %W %K %k %c %t %D";
-
-    call({impl_->full_name, "tag", "bind", tag, event, script});
+    exec({impl_->full_name, "tag", "bind", tag, event, Interpreter::event_script(cb_name, fields)});
     return *this;
 }
 
 std::vector<std::string> Treeview::tag_has(const std::string& tag) const
 {
-    auto ret = call({impl_->full_name, "tag", "has", tag});
-    return impl_->interp->split_list(ret);
+    return call_list({impl_->full_name, "tag", "has", tag});
 }
 
 std::string Treeview::identify_row(int y) const
@@ -4308,14 +6772,9 @@ std::vector<int> Treeview::bbox(const std::string& iid, const std::string& colum
     if (!column.empty())
         words.push_back(column);
 
+    // 失敗時は例外を投げず空を返す(call_int_list()は失敗時に空を返す)。
     bool ok = false;
-    auto ret = call(words, &ok);
-    std::vector<int> out;
-    if (!ok)
-        return out;
-    for (const auto& token : impl_->interp->split_list(ret))
-        out.push_back(safe_stol(token.c_str()));
-    return out;
+    return call_int_list(words, &ok);
 }
 
 } // ttk
@@ -4323,21 +6782,19 @@ std::vector<int> Treeview::bbox(const std::string& iid, const std::string& colum
 namespace colorchooser
 {
 
-std::string askcolor(const std::map<std::string, ArgValue>& options)
+std::string askcolor(const Options& options)
 {
-    auto* interp = cpp_tk::interp_map[std::this_thread::get_id()];
+    auto* interp = existing_interp();
     if (!interp)
         return "";
 
     std::vector<ArgValue> words = {"tk_chooseColor"};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
 
     bool ok = false;
     auto ret = interp->call(words, &ok);
+    if (!ok)
+        report_tcl_failure(*interp, "askcolor", &ok);
     return ok ? ret : "";
 }
 
@@ -4346,46 +6803,46 @@ std::string askcolor(const std::map<std::string, ArgValue>& options)
 namespace filedialog
 {
 
-static std::string invoke_dialog(const std::string& cmd_name, const std::map<std::string, ArgValue>& options)
+static std::string invoke_dialog(const std::string& cmd_name, const Options& options)
 {
-    auto* interp = interp_map[std::this_thread::get_id()];
+    auto* interp = existing_interp();
     if (!interp) return "";
     std::vector<ArgValue> words = {cmd_name};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
-    return interp->call(words);
+    options.append_to(words);
+    bool ok = false;
+    auto ret = interp->call(words, &ok);
+    if (!ok)
+        report_tcl_failure(*interp, "filedialog", &ok);
+    return ret;
 }
 
-std::string askopenfile(const std::map<std::string, ArgValue>& options)
+std::string askopenfile(const Options& options)
 {
     return invoke_dialog("tk_getOpenFile", options);
 }
 
-std::vector<std::string> askopenfilenames(const std::map<std::string, ArgValue>& options)
+std::vector<std::string> askopenfilenames(const Options& options)
 {
-    auto* interp = interp_map[std::this_thread::get_id()];
+    auto* interp = existing_interp();
     if (!interp) return {};
 
     std::vector<ArgValue> words = {"tk_getOpenFile", "-multiple", 1};
-    for (const auto& kv : options)
-    {
-        words.push_back("-" + kv.first);
-        words.push_back(kv.second);
-    }
+    options.append_to(words);
     // 戻り値はTclのリスト形式(要素にスペースを含む場合は{}で囲まれる)のため、
     // 単純な空白splitではなくTcl_SplitListで正しく要素分解する。
-    return interp->split_list(interp->call(words));
+    bool ok = false;
+    auto ret = interp->call(words, &ok);
+    if (!ok)
+        report_tcl_failure(*interp, "askopenfilenames", &ok);
+    return interp->split_list(ret);
 }
 
-std::string asksaveasfilename(const std::map<std::string, ArgValue>& options)
+std::string asksaveasfilename(const Options& options)
 {
     return invoke_dialog("tk_getSaveFile", options);
 }
 
-std::string askdirectory(const std::map<std::string, ArgValue>& options) 
+std::string askdirectory(const Options& options) 
 {
     return invoke_dialog("tk_chooseDirectory", options);
 }
@@ -4397,9 +6854,13 @@ namespace messagebox
 
 static std::string msgbox(const std::string& type, const std::string& icon, const std::string& title, const std::string& message)
 {
-    auto* interp = interp_map[std::this_thread::get_id()];
+    auto* interp = existing_interp();
     if (!interp) return "";
-    return interp->call({"tk_messageBox", "-type", type, "-icon", icon, "-title", title, "-message", message});
+    bool ok = false;
+    auto ret = interp->call({"tk_messageBox", "-type", type, "-icon", icon, "-title", title, "-message", message}, &ok);
+    if (!ok)
+        report_tcl_failure(*interp, "messagebox", &ok);
+    return ret;
 }
 
 std::string showinfo(const std::string& title, const std::string& message) 
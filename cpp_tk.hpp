@@ -10,6 +10,11 @@
 #include <array>
 #include <cstdint>
 #include <stdexcept>
+#include <chrono>
+#include <thread>
+
+// tcl.hをincludeせずにTcl_Obj*を保持するための前方宣言(tcl.hの"typedef struct Tcl_Obj {...} Tcl_Obj;"と互換)。
+struct Tcl_Obj;
 
 namespace cpp_tk
 {
@@ -91,18 +96,121 @@ struct Event
     int         keycode;
     std::string type;
     int         delta;
+    int         coalesced;  // Coalesce::LATESTで、この呼び出しにまとめられて捨てられた古いイベントの数
     
 };
 
+/**
+ * bind()等でTkに置換(%x等)させ、Eventに読み込むフィールドの選択(ビットの組み合わせ)。既定のALLは全フィールドを
+ * 置換させるが、<Motion>ならPOSITIONだけ、<Key>ならKEYSYMだけのように絞ると、Tkが組み立てるスクリプトと
+ * コールバック側の読み取りがその分だけ減る。選ばなかったフィールドは既定値(0/空文字列)のままになる。
+ */
+enum class EventField : unsigned
+{
+    X             = 1u << 0,  // %x
+    Y             = 1u << 1,  // %y
+    X_ROOT        = 1u << 2,  // %X
+    Y_ROOT        = 1u << 3,  // %Y
+    WIDGET        = 1u << 4,  // %W
+    KEYSYM        = 1u << 5,  // %K
+    KEYCODE       = 1u << 6,  // %k
+    CHARACTER     = 1u << 7,  // %c
+    TYPE          = 1u << 8,  // %t
+    DELTA         = 1u << 9,  // %D
+    POSITION      = X | Y,
+    ROOT_POSITION = X_ROOT | Y_ROOT,
+    KEY           = KEYSYM | KEYCODE,
+    ALL           = (1u << 10) - 1,
+};
+
+constexpr EventField operator|(EventField a, EventField b)
+{
+    return static_cast<EventField>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+constexpr EventField operator&(EventField a, EventField b)
+{
+    return static_cast<EventField>(static_cast<unsigned>(a) & static_cast<unsigned>(b));
+}
+
+/** fieldsにfieldのビットが(いずれか一つでも)含まれているかを返す。 */
+constexpr bool has_event_field(EventField fields, EventField field)
+{
+    return static_cast<unsigned>(fields & field) != 0;
+}
+
+/**
+ * bind()等で登録したコールバックへのイベントの届け方。<Motion>/<B1-Motion>/<Configure>/<MouseWheel>の
+ * ように頻繁に起きるイベントで処理が重い場合、LATESTにするとイベントの発生ごとに呼ばずに最新の
+ * イベントだけを覚えておき、次のアイドル時(Tkの再描画と同じ時点)に1回だけ呼ぶ。それまでに捨てた
+ * 古いイベントの数はEvent::coalescedに入る。
+ */
+enum class Coalesce
+{
+    NONE,    // イベントごとに呼ぶ(既定)
+    LATEST,  // 最新のイベントだけを、次のアイドル時に1回呼ぶ(schedule_idle()と同じキューを使う)
+};
+
 class Interpreter;
 class Widget;
 class Var;
+class TclValue;
+
+/**
+ * 所有権を持たない文字列(先頭ポインタ+長さ)。Text::insert/PhotoImage::put/clipboard_append等へ渡す
+ * 数MB級のペイロードを、ArgValueへのコピーを経ずにTcl_Objへ1回だけコピーさせるために使う。
+ * 参照先は、それを渡したcall()等の呼び出しが戻るまで有効でなければならない(tk::Batch中も、溜める
+ * 時点でTcl_Objへコピーされるため同じ条件でよい)。std::stringからの変換は、一時文字列を借用して
+ * しまう事故を避けるためexplicitにしている。
+ */
+struct StringRef
+{
+    const char* data;
+    std::size_t size;
+
+    StringRef(const char* data, std::size_t size) : data(data), size(size) {}
+
+    explicit StringRef(const std::string& s) : data(s.data()), size(s.size()) {}
+};
+
+/**
+ * 所有権を持たない数値配列(先頭ポインタ+要素数)。ArgValueに渡すと、要素ごとにArgValue/語を作らず
+ * 1回のTcl_NewListObjで1つのTclリストに変換される(Canvasの座標列等)。参照先の有効期間の条件は
+ * StringRefと同じ。std::vectorからは暗黙に変換できるが、ArgValueへは明示的に包んでから渡す
+ * (暗黙のユーザー定義変換は1回までのため。例: `tk::DoubleArrayRef(points)`)。
+ */
+struct IntArrayRef
+{
+    const int*  data;
+    std::size_t size;
+
+    IntArrayRef(const int* data, std::size_t size) : data(data), size(size) {}
+
+    IntArrayRef(const std::vector<int>& v) : data(v.data()), size(v.size()) {}
+};
+
+/** IntArrayRefのdouble版。 */
+struct DoubleArrayRef
+{
+    const double* data;
+    std::size_t   size;
+
+    DoubleArrayRef(const double* data, std::size_t size) : data(data), size(size) {}
+
+    DoubleArrayRef(const std::vector<double>& v) : data(v.data()), size(v.size()) {}
+};
+struct WidgetCommandCache;
+struct TimerState;
 
 /**
  * JSON的な合成(配列の中に辞書、辞書の中に配列を任意にネストできる)を許容するタグ付き共用体。
  * LIST/DICTの要素・値はいずれもArgValue自身なので、相互ネストは追加実装なしに成立する。
  * かつて存在した`STRING_LIST`(フラットな文字列リスト専用、-filetypes等の入れ子構造を表現
  * できなかった)は廃止し、`LIST`に一本化した(docs/tasks.md K節参照)。
+ * 値は型ごとに1つの共用体に格納する。STRING/BYTESは共用体の中に直接構築するため、短い文字列は
+ * std::string自身の短文字列最適化によりヒープ確保無しで収まる。LIST/DICTは自分自身を要素に持つため
+ * ヒープに置く。ムーブはnoexceptで中身を奪うだけなので、std::vector<ArgValue>の再確保でも
+ * 深いコピーは発生しない(docs/tasks.md M節5.参照)。
  */
 class ArgValue
 {
@@ -116,13 +224,20 @@ public:
         BOOL,
         BYTES, // バイナリデータ (PhotoImage 等) 用
         LIST,  // Tclのリスト値(要素は任意のArgValue、入れ子可。例: -filetypes)
-        DICT   // Tclの辞書値(値は任意のArgValue、入れ子可)
+        DICT,  // Tclの辞書値(値は任意のArgValue、入れ子可)
+        OBJ,   // 構築済みのTcl_Obj(TclValue)。変換せずそのまま共有して渡す
+        STRING_REF,   // 借用した文字列(StringRef)。ArgValue自身はコピーせず、Tcl_Obj生成時に1回だけコピーする
+        INT_ARRAY,    // 借用した数値配列(IntArrayRef)。1つのTclリストとして渡す
+        DOUBLE_ARRAY  // 借用した数値配列(DoubleArrayRef)。1つのTclリストとして渡す
     };
 
-    ArgValue();
+    ArgValue() noexcept;
 
     ArgValue(const std::string& s);
 
+    /** `"-" + kv.first`のような一時文字列はコピーせずムーブで受け取る。 */
+    ArgValue(std::string&& s) noexcept;
+
     ArgValue(const char* s);
 
     ArgValue(int v);
@@ -147,10 +262,25 @@ public:
      */
     ArgValue(Var& var);
 
+    /** 借用した文字列を渡す(STRING_REF型)。ArgValueをコピーしても参照先は共有されたまま(複製されない)。 */
+    ArgValue(const StringRef& ref) noexcept;
+
+    /** 借用した数値配列を1つのTclリストとして渡す(INT_ARRAY/DOUBLE_ARRAY型)。StringRefと同様、コピーしても参照先は共有される。 */
+    ArgValue(const IntArrayRef& ints) noexcept;
+
+    ArgValue(const DoubleArrayRef& doubles) noexcept;
+
+    /** 構築済みのTcl_Objを共有して渡す(OBJ型、make_obj()による再構築を省く)。空のTclValueはNONEになる。 */
+    ArgValue(const TclValue& value);
+
     ArgValue(const ArgValue& other);
 
+    ArgValue(ArgValue&& other) noexcept;
+
     ArgValue& operator=(const ArgValue& other);
 
+    ArgValue& operator=(ArgValue&& other) noexcept;
+
     ~ArgValue();
 
     ValueType type() const;
@@ -159,26 +289,86 @@ public:
     int                          as_int()    const { return i_; }
     double                       as_double() const { return d_; }
     bool                         as_bool()   const { return b_; }
-    const std::string&           as_string() const { return *str_; }
-    const std::vector<uint8_t>&  as_bytes()  const { return *bytes_; }
+    const std::string&           as_string() const { return str_; }
+    const std::vector<uint8_t>&  as_bytes()  const { return bytes_; }
     const std::vector<ArgValue>& as_list()   const { return *list_; }
     const std::map<std::string, ArgValue>& as_dict() const { return *dict_; }
+    Tcl_Obj*                     as_obj()    const { return obj_; }
+    const StringRef&             as_string_ref() const { return ref_; }
+    const IntArrayRef&           as_int_array() const { return ints_; }
+    const DoubleArrayRef&        as_double_array() const { return doubles_; }
 
 private:
     ValueType               type_;
     union
     {
-        int     i_;
-        double  d_;
-        bool    b_;
+        int                              i_;
+        double                           d_;
+        bool                             b_;
+        std::string                      str_;
+        std::vector<uint8_t>             bytes_;
+        std::vector<ArgValue>*           list_;
+        std::map<std::string, ArgValue>* dict_;
+        Tcl_Obj*                         obj_;   // 参照カウントを1つ保持する
+        StringRef                        ref_;
+        IntArrayRef                      ints_;
+        DoubleArrayRef                   doubles_;
     };
-    std::string*                     str_;
-    std::vector<uint8_t>*            bytes_;
-    std::vector<ArgValue>*           list_;
-    std::map<std::string, ArgValue>* dict_;
 
-    void cleanup();
+    void cleanup() noexcept;
     void copy_from(const ArgValue& other);
+    void move_from(ArgValue& other) noexcept;
+};
+
+/**
+ * 構築済みのTcl値(Tcl_Obj)を参照カウント付きで保持する不透明なハンドル。大きい・繰り返し使う引数
+ * (ポリラインの座標列、Combobox::valuesの-values、-filetypesの入れ子構造等)を一度だけTcl値に
+ * 変換しておき、ArgValue経由で何度call()に渡してもmake_obj()による再構築を行わずに共有させる。
+ * InterpreterClient::call_value()の結果として受け取れば、あるTclコマンドの結果を文字列を経由せずに
+ * 次のコマンドへそのまま渡せる。Tcl_Objはそれを作ったスレッドでしか扱えないため、TclValueも
+ * 作成したスレッド(のInterpreter)でのみ使うこと。
+ */
+class TclValue
+{
+
+public:
+
+    /** 空の値(ArgValueとして渡すとNONE扱いになる)。 */
+    TclValue() noexcept;
+
+    /**
+     * valueを今この場で一度だけTcl値に変換して保持する。Interpreterは作らず、呼び出しスレッドにまだ無ければ
+     * Tclのライブラリだけを初期化するため、ディスプレイの無い環境でも構築できる。
+     */
+    explicit TclValue(const ArgValue& value);
+
+    TclValue(const TclValue& other);
+
+    TclValue(TclValue&& other) noexcept;
+
+    TclValue& operator=(const TclValue& other);
+
+    TclValue& operator=(TclValue&& other) noexcept;
+
+    ~TclValue();
+
+    bool empty() const { return obj_ == nullptr; }
+
+    /** Tclの文字列表現を返す(空ならば空文字列)。 */
+    std::string str() const;
+
+    /** 保持しているTcl_Obj(空ならnullptr)。ArgValue/Interpreterの内部変換用。 */
+    Tcl_Obj* obj() const { return obj_; }
+
+private:
+
+    friend class InterpreterClient;
+
+    /** objの参照カウントを1つ増やして保持する(InterpreterClient::call_value()用)。 */
+    static TclValue adopt(Tcl_Obj* obj);
+
+    Tcl_Obj* obj_;
+
 };
 
 /**
@@ -196,6 +386,100 @@ ArgValue list(std::initializer_list<ArgValue> items);
  *  ネストする場合は内側でもlist()/dict()を明示的に呼ぶ必要がある。 */
 ArgValue dict(std::initializer_list<std::pair<const std::string, ArgValue>> items);
 
+/**
+ * ウィジェットのオプション列("-name value ..."の平坦な語の並び)。std::map<std::string, ArgValue>を
+ * 受け取っていた全APIはこの型を受け取り、従来の波括弧リテラル・std::mapからは暗黙に変換される
+ * (従来どおりキー順に並べ、重複キーは先勝ち)。
+ * opts()から始めるビルダー形式(`tk::opts().text("x").width(3).fill(tk::FILL_BOTH)`)では、
+ * mapのノード確保も"-" + keyの文字列連結も行わない。オプション名は静的文字列へのStringRefとして
+ * 保持され、Interpreterがインターン済みのTcl_Objに解決する。ビルダーに無いオプションはset()で追加する。
+ * -in/-fromはtkinterと同じくin_()/from_()とした。
+ */
+class Options
+{
+public:
+    Options() {}
+
+    Options(const std::map<std::string, ArgValue>& options);
+
+    Options(std::initializer_list<std::pair<const std::string, ArgValue>> options);
+
+    /** 名前を指定してオプションを追加する(nameは先頭の"-"を含まない)。 */
+    Options& set(const std::string& name, ArgValue value);
+
+    Options& text(ArgValue value) { return add(StringRef("-text", 5), std::move(value)); }
+    Options& textvariable(ArgValue value) { return add(StringRef("-textvariable", 13), std::move(value)); }
+    Options& variable(ArgValue value) { return add(StringRef("-variable", 9), std::move(value)); }
+    Options& value(ArgValue value) { return add(StringRef("-value", 6), std::move(value)); }
+    Options& values(ArgValue value) { return add(StringRef("-values", 7), std::move(value)); }
+    Options& command(ArgValue value) { return add(StringRef("-command", 8), std::move(value)); }
+    Options& image(ArgValue value) { return add(StringRef("-image", 6), std::move(value)); }
+    Options& width(ArgValue value) { return add(StringRef("-width", 6), std::move(value)); }
+    Options& height(ArgValue value) { return add(StringRef("-height", 7), std::move(value)); }
+    Options& fill(ArgValue value) { return add(StringRef("-fill", 5), std::move(value)); }
+    Options& expand(ArgValue value) { return add(StringRef("-expand", 7), std::move(value)); }
+    Options& side(ArgValue value) { return add(StringRef("-side", 5), std::move(value)); }
+    Options& anchor(ArgValue value) { return add(StringRef("-anchor", 7), std::move(value)); }
+    Options& padx(ArgValue value) { return add(StringRef("-padx", 5), std::move(value)); }
+    Options& pady(ArgValue value) { return add(StringRef("-pady", 5), std::move(value)); }
+    Options& ipadx(ArgValue value) { return add(StringRef("-ipadx", 6), std::move(value)); }
+    Options& ipady(ArgValue value) { return add(StringRef("-ipady", 6), std::move(value)); }
+    Options& row(ArgValue value) { return add(StringRef("-row", 4), std::move(value)); }
+    Options& column(ArgValue value) { return add(StringRef("-column", 7), std::move(value)); }
+    Options& rowspan(ArgValue value) { return add(StringRef("-rowspan", 8), std::move(value)); }
+    Options& columnspan(ArgValue value) { return add(StringRef("-columnspan", 11), std::move(value)); }
+    Options& sticky(ArgValue value) { return add(StringRef("-sticky", 7), std::move(value)); }
+    Options& in_(ArgValue value) { return add(StringRef("-in", 3), std::move(value)); }
+    Options& x(ArgValue value) { return add(StringRef("-x", 2), std::move(value)); }
+    Options& y(ArgValue value) { return add(StringRef("-y", 2), std::move(value)); }
+    Options& relx(ArgValue value) { return add(StringRef("-relx", 5), std::move(value)); }
+    Options& rely(ArgValue value) { return add(StringRef("-rely", 5), std::move(value)); }
+    Options& relwidth(ArgValue value) { return add(StringRef("-relwidth", 9), std::move(value)); }
+    Options& relheight(ArgValue value) { return add(StringRef("-relheight", 10), std::move(value)); }
+    Options& bg(ArgValue value) { return add(StringRef("-bg", 3), std::move(value)); }
+    Options& fg(ArgValue value) { return add(StringRef("-fg", 3), std::move(value)); }
+    Options& background(ArgValue value) { return add(StringRef("-background", 11), std::move(value)); }
+    Options& foreground(ArgValue value) { return add(StringRef("-foreground", 11), std::move(value)); }
+    Options& font(ArgValue value) { return add(StringRef("-font", 5), std::move(value)); }
+    Options& state(ArgValue value) { return add(StringRef("-state", 6), std::move(value)); }
+    Options& relief(ArgValue value) { return add(StringRef("-relief", 7), std::move(value)); }
+    Options& borderwidth(ArgValue value) { return add(StringRef("-borderwidth", 12), std::move(value)); }
+    Options& bd(ArgValue value) { return add(StringRef("-bd", 3), std::move(value)); }
+    Options& outline(ArgValue value) { return add(StringRef("-outline", 8), std::move(value)); }
+    Options& tags(ArgValue value) { return add(StringRef("-tags", 5), std::move(value)); }
+    Options& orient(ArgValue value) { return add(StringRef("-orient", 7), std::move(value)); }
+    Options& from_(ArgValue value) { return add(StringRef("-from", 5), std::move(value)); }
+    Options& to(ArgValue value) { return add(StringRef("-to", 3), std::move(value)); }
+    Options& length(ArgValue value) { return add(StringRef("-length", 7), std::move(value)); }
+    Options& justify(ArgValue value) { return add(StringRef("-justify", 8), std::move(value)); }
+    Options& wrap(ArgValue value) { return add(StringRef("-wrap", 5), std::move(value)); }
+    Options& cursor(ArgValue value) { return add(StringRef("-cursor", 7), std::move(value)); }
+    Options& takefocus(ArgValue value) { return add(StringRef("-takefocus", 10), std::move(value)); }
+    Options& style(ArgValue value) { return add(StringRef("-style", 6), std::move(value)); }
+    Options& selectmode(ArgValue value) { return add(StringRef("-selectmode", 11), std::move(value)); }
+    Options& show(ArgValue value) { return add(StringRef("-show", 5), std::move(value)); }
+    Options& label(ArgValue value) { return add(StringRef("-label", 6), std::move(value)); }
+    Options& menu(ArgValue value) { return add(StringRef("-menu", 5), std::move(value)); }
+    Options& underline(ArgValue value) { return add(StringRef("-underline", 10), std::move(value)); }
+
+    bool empty() const { return words_.empty(); }
+
+    /** オプション名と値を交互に並べた語の列。 */
+    const std::vector<ArgValue>& words() const { return words_; }
+
+    /** words()をコマンドの語の末尾に追加する。 */
+    void append_to(std::vector<ArgValue>& words) const;
+
+private:
+    Options& add(ArgValue&& name, ArgValue&& value);
+
+    std::vector<ArgValue> words_;
+
+};
+
+/** Optionsビルダーの起点。 */
+inline Options opts() { return Options(); }
+
 /** cpp_tkが送出する唯一の例外型。Tcl呼び出し失敗・未初期化オブジェクトへのアクセス等、理由はwhat()で判別する。 */
 class Error : public std::runtime_error
 {
@@ -250,6 +534,148 @@ ErrorPolicy error_policy();
  */
 void set_callback_exception_handler(std::function<void(const std::exception&)> handler);
 
+/**
+ * cpp_tkが報告したエラー1件分の記録(Tcl呼び出しの失敗、未初期化オブジェクトへのアクセス等)。
+ * 報告時には構成要素(操作名・失敗の種類・Tclのエラーメッセージ・失敗したコマンドの語)を保持するだけで、
+ * what()/command()/message()の文字列は呼ばれた時に組み立てる。
+ */
+struct ErrorRecord
+{
+    /** 失敗の種類。what()の文言を決める。 */
+    enum class Kind
+    {
+        TCL_FAILURE,           // Tclコマンドの評価に失敗した
+        UNINITIALIZED,         // 未初期化のオブジェクト(interp == nullptr)への呼び出し
+        WRONG_THREAD,          // Tcl_Interpの所有スレッド以外からの呼び出し
+        THREAD_EXITED,         // 所有スレッドの終了でTcl_Interpが破棄済みのオブジェクトへの呼び出し
+        UNEXPECTED_ARGUMENTS,  // 引数を取らないScriptのrun()に引数が渡された
+    };
+
+    ErrorPolicy              category;       // 対応するErrorPolicyのカテゴリ
+    Kind                     kind;           // 失敗の種類
+    const char*              operation;      // 失敗した操作名("call"等。静的な文字列)
+    const char*              object_type;    // 呼び出し先のオブジェクトの型名("Label"等。静的な文字列。Tcl呼び出しの失敗ではnullptr)
+    std::string              detail;         // Tclのエラーメッセージ(Tcl呼び出し以外の失敗では空)
+    std::vector<std::string> command_words;  // 失敗したTclコマンドの語(Tcl呼び出し以外の失敗では空)
+    std::size_t              suppressed;     // この記録の前に、同じ呼び出し箇所でレート制限により間引かれた件数
+    std::thread::id          thread;         // 報告したスレッド
+
+    /** 何が失敗したか("call() failed to execute Tcl command"等)。 */
+    std::string what() const;
+
+    /** 失敗したTclコマンド(command_wordsの空白区切り)。 */
+    std::string command() const;
+
+    /** "<what>: <detail> (command: <command>)"の形式の1行に整形する(空の項目は省く)。 */
+    std::string message() const;
+};
+
+/**
+ * エラーの通知先を差し替える(nullptrで既定のstderr出力に戻す)。handlerは、エラーを報告したスレッド上で
+ * レート制限を通過した記録ごとに同期的に呼ばれる。ErrorPolicyにより例外が送出される場合も、送出の前に呼ばれる。
+ */
+void set_error_handler(std::function<void(const ErrorRecord&)> handler);
+
+/**
+ * 同じ呼び出し箇所(操作と失敗の種類、Tcl呼び出しの失敗では失敗したコマンドの先頭2語)からのエラーを、interval当たり1件に間引く
+ * (既定は1秒、0で間引かない)。描画ループで同じ失敗が毎フレーム起きても、通知は1秒に1回になる。
+ * 間引かれた件数は、次に通知される記録のsuppressedに載る。間引き自体は報告スレッドごとに行う。
+ * 例外の送出(ErrorPolicy)は間引かれない。
+ */
+void set_error_rate_limit(std::chrono::milliseconds interval);
+
+/**
+ * 通知済みの記録を古い順に取り出し、バッファから取り除く。記録は全スレッド共通のロックフリーな
+ * リングバッファ(直近256件)に溜められ、満杯なら最も古い記録から捨てられる(エラーが続いても直近の記録が残る)。
+ * どのスレッドから呼び出してもよい。
+ */
+std::vector<ErrorRecord> drain_errors();
+
+/**
+ * Interpreterを持つ(cpp_tkのオブジェクトを構築したことのある)スレッドの一覧を返す。終了したスレッドは
+ * 一覧から外れ、そのInterpreter(Tcl_Interp)も破棄される(メインスレッドを除く)。どのスレッドから
+ * 呼び出してもよい。各スレッドの呼び出しが自スレッドのInterpreterを引く経路はスレッドローカル変数の
+ * 読み出しだけで、この一覧のロックは取らない。
+ */
+std::vector<std::thread::id> interpreter_threads();
+
+/**
+ * 呼び出しスレッドのInterpreterを、Tk_Init()を行わないTclのみのモードで生成する。ディスプレイの無い
+ * 環境でも動き、起動もTkの初期化の分だけ速い。Var/TclValue/Script/call()/call_list()等のTkに依存しない
+ * 機能はそのまま使える(Tkのコマンドを呼ぶと通常のTclエラーになる)。後からtk::Tkを構築すると、その時点で
+ * 同じInterpreterにTkを読み込む。呼び出しスレッドで最初にcpp_tkのオブジェクトを構築するより前に呼ぶ必要が
+ * あり、既にInterpreterがあれば何もせずfalseを返す。
+ */
+bool create_tcl_only_interpreter();
+
+/**
+ * コールバックの登録状況(tk::stats()参照)。値は全スレッドの合計で、計数は相互に同期しないため、
+ * 他スレッドが登録・解放している最中に読んだ値は目安として扱う。
+ */
+struct Stats
+{
+    std::size_t live_callbacks;      // 生存中のコールバック(bind/command/after/変数トレース等)の数
+    std::size_t callbacks_created;   // これまでに登録されたコールバックの累計
+    std::size_t callbacks_released;  // これまでに解放されたコールバックの累計
+    std::size_t callback_owners;     // コールバックを持つ生存中のウィジェットの数
+};
+
+/**
+ * コールバックの登録状況を返す。コールバックは、after()/after_idle()なら呼ばれた時点(after_cancel()なら
+ * 取り消した時点)で、ウィジェットに登録したもの(bind/command/scroll/validate/メニュー項目等)はそのウィジェットの
+ * 破棄・unbind()・再登録で、変数トレースはそのVar(とコピー)が全て破棄された時点・再トレース・unsetで解放される。長時間動かすアプリケーションで
+ * live_callbacksが増え続けないことの確認に使う。
+ */
+Stats stats();
+
+/**
+ * コールバック1つ分の呼び出しの計測結果(tk::callback_stats()参照)。
+ */
+struct CallbackStats
+{
+    std::string                name;         // Tclコマンド名(cpp_tk_cb<N>)。変数トレースは"trace <N>"、post()は"post <N>"、Timerは"timer <N>"、Animatorの更新処理は"animator <N>/<id>"、schedule_idle()は実行のたびに"idle"に合算。解放済みのものは"after"/"trace"/"post"/"timer"/"animator"/"released"に合算される
+    std::string                description;  // 登録先("<ウィジェットのパス> <役割>"、例: ".!frame bind <Motion>"。変数トレースは変数名)。分からなければ空
+    std::size_t                calls;        // 呼び出し回数
+    std::chrono::nanoseconds   total_time;   // 所要時間の合計
+    std::chrono::nanoseconds   max_time;     // 1回の所要時間の最大
+    std::array<std::size_t, 8> histogram;    // 所要時間の分布。区間の上限は順に0.1/0.5/1/2/4/8/16ms、最後は16ms以上
+};
+
+/**
+ * コールバック(bind/command/after/変数トレース/post()等)の呼び出し回数と所要時間の計測を切り替える
+ * (既定は無効で、無効の間の追加コストはフラグの読み出し1回だけ)。UIが引っかかる時に、どのハンドラが
+ * フレームの時間を使っているかを外部のプロファイラなしで調べるためのもの。全スレッド共通の設定。
+ */
+void set_callback_profiling(bool enabled);
+
+/**
+ * 呼び出しスレッドで計測したコールバックごとの結果を、所要時間の合計の多い順に返す。
+ * 解放されたコールバックの結果は種類ごとの合算("after"/"trace"/"post"/"idle"/"timer"/"animator"/"released")に畳み込まれるため、
+ * 作っては捨てるコールバックがあっても記録は増え続けない。合算もreset_callback_stats()で消すまで残る。
+ */
+std::vector<CallbackStats> callback_stats();
+
+/** 呼び出しスレッドの計測結果を消す。 */
+void reset_callback_stats();
+
+/**
+ * 呼び出しスレッドのイベントループ上で、intervalごとにcallback_stats()の結果をsinkへ渡す(sinkが空なら
+ * stderrへ出力する)。intervalに0を渡すと止める。計測自体はset_callback_profiling(true)で有効にする。
+ * 出力はmainloop()/update()等でイベントを処理している間だけ行われる。
+ */
+void set_callback_stats_dump(std::chrono::milliseconds interval,
+                             std::function<void(const std::vector<CallbackStats>&)> sink = nullptr);
+
+/**
+ * 呼び出しスレッドのTclインタプリタを破棄し、新しく作り直す(Tclのみのモードかどうかは引き継ぐ)。
+ * 登録済みのコールバック・変数トレース・after・未実行のpost()・溜めたtk::Batchのコマンドも破棄される。
+ * テストやベンチマークを1プロセス内で独立に繰り返すためのもの。作り直し前に構築したWidget/Var/Font等は
+ * 安全に破棄・呼び出しできるが、対応するTclのコマンドや変数はもう存在しないため、呼び出しは通常のTclエラー
+ * (ErrorPolicyに従う)になる。コールバックやmainloop()の中からは呼べない(Errorを送出する)。
+ * Interpreterがまだ無いスレッドでは、通常どおり新しく生成するだけ。
+ */
+void reset_interpreter();
+
 /**
  * Tcl_Init()/Tk_Init()が探索するランタイムスクリプト一式(init.tcl/tk.tcl等)の格納先を明示指定する
  * (docs/tasks.md H節参照)。システムにTcl/Tkが標準インストールされていない配布環境向けのフォールバック。
@@ -279,11 +705,32 @@ public:
      */
     std::string call(const std::vector<ArgValue>& words, bool* success = nullptr) const;
 
+    /**
+     * call()と同じだが、結果を文字列に整形してから解析し直すのではなく、結果のTcl_Objの内部表現から
+     * 直接int/double/bool/リストとして読む(Tcl_GetIntFromObj/Tcl_ListObjGetElements等)。
+     * 失敗時の扱い(success/error_policy())はcall()と同じで、その場合は0/0.0/false/空を返す。
+     * 結果が該当する型として解釈できない場合(Tkが"??"を返した場合等)も同じ既定値を返す。
+     */
+    int call_int(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    double call_double(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    bool call_bool(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    std::vector<std::string> call_list(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    /** call_list()の各要素をcall_int()と同じ規則で整数として読む(bbox/curselection等の座標・index列向け)。 */
+    std::vector<int> call_int_list(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    /** 結果のTcl_Objをそのまま(文字列化せずに)TclValueとして返す。失敗時は空のTclValueを返す。 */
+    TclValue call_value(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
     /**
      * jobを、このオブジェクトが紐づくInterpreter(Tcl_Interp)の所有スレッド上で安全に実行させる。
      * call()等と異なりpost()自体はどのスレッドから呼び出しても安全(Tcl_ThreadQueueEventで対象
      * スレッドのTclイベントループへjobを注入する、Python root.after(0, callback)+queue.Queue相当)。
-     * post()の呼び出し自体はjobの完了を待たずに戻る(非同期)。
+     * post()の呼び出し自体はjobの完了を待たずに戻る(非同期)。所有スレッドが終了済みの場合、jobは実行されずに
+     * 破棄され、error_policy()に従って報告される。
      */
     void post(std::function<void()> job) const;
 
@@ -297,6 +744,14 @@ protected:
     /** 診断メッセージに使うクラス名。派生クラスは必要に応じてoverrideする。 */
     virtual const char* type_name() const { return "object"; }
 
+    /**
+     * 自分のTclパス名を表すキャッシュ済みのTcl_Obj(無ければnullptr)。call()は渡されたwordsのうち
+     * これと同じ文字列の語をTcl_Objの新規生成ではなくこのオブジェクトの再利用で済ませる
+     * (Tclはコマンド解決結果をTcl_Obj自身にキャッシュするため、同じオブジェクトを使い回すほど
+     * 繰り返しのTcl_EvalObjvが安くなる)。
+     */
+    virtual Tcl_Obj* path_obj() const { return nullptr; }
+
     /**
      * interp()を呼び、nullptrなら「<operation>() called on an uninitialized <type_name()>」という
      * エラーメッセージを出力する。call()以外の操作(Var::get_var/set_var/trace_var等)でも
@@ -307,8 +762,242 @@ protected:
      */
     Interpreter* checked_interp(const char* operation, bool* success = nullptr) const;
 
+    /**
+     * checked_interp()を通した上でwordsを評価し、成功すればそのInterpreterを返す(結果は
+     * Interpreter側に残っている)。失敗時はcall()と同じくsuccess/error_policy()に従ってから
+     * nullptrを返す。call_int()等の型付き版の共通部分。
+     */
+    Interpreter* eval_checked(const char* operation, const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    /**
+     * Tclの結果を使わない呼び出し(config/pack/grid/Canvas::coords等のsetter)用のcall()。tk::Batchが
+     * 有効な間はその場で評価せずに溜めておき、Batchのスコープ終了時にまとめて評価する。失敗時の扱いは
+     * call()と同じ(ただしバッチ中の失敗はBatch側で報告される)。
+     */
+    bool exec(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+    /**
+     * 結果を使わないが、tk::Batch中でも溜めずにその場で評価するexec()。Widgetの生成やdestroy/event generate/
+     * focus/grab/clipboard/font create/option add/image create/deleteのように、遅らせると後続の呼び出しから見た状態や
+     * イベントの順序が変わる副作用を持つコマンド用。それまでに溜めたコマンドは先に評価する。
+     */
+    bool exec_now(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
+};
+
+/**
+ * スコープ内(呼び出しスレッドのInterpreterに対する)のsetter系呼び出し(config/pack/grid/place、
+ * Canvas::coords/move/itemconfig、Treeview::insert/item/erase等、Tclの結果を使わないもの)をその場で
+ * 評価せずに溜めておき、スコープを抜けた時(またはflush()時)に1回のループでまとめて評価する。
+ * 多数の行へのTreeview::insert/itemやCanvasの再描画のように多数のsetterを連続して呼ぶ場面で、
+ * 呼び出しごとの結果の文字列化・エラー処理の往復を省く。Widgetの生成は溜めずにその場で評価する
+ * (直後のcommand()/bind()等がウィジェットコマンドの存在を前提とするため)。
+ * getter(cget/winfo_*等)やcall()のように結果を必要とする呼び出しが来た場合は、呼び出し順を保つため
+ * それまでに溜めたコマンドを先に評価してから実行する(この暗黙の評価で失敗したコマンドは"batch"の失敗として
+ * ログのみとし、getter自体は通常通り実行する)。入れ子にした場合は最も外側のBatchでのみ評価する。
+ * 失敗したコマンドは1件ずつcall()と同じくerror_policy()に従って報告される。ただしデストラクタからは
+ * 例外を送出できないため、スコープ終了時の評価ではログのみとなる。失敗をErrorとして受け取りたい
+ * 場合はスコープを抜ける前にflush()を明示的に呼ぶ。
+ */
+class Batch
+{
+
+public:
+
+    /** 呼び出しスレッドのcurrent interpreter(StringVar()と同じ流儀。無ければその場で生成される)に対してバッチを開始する。 */
+    Batch();
+
+    Batch(const Batch&) = delete;
+
+    Batch& operator=(const Batch&) = delete;
+
+    ~Batch();
+
+    /**
+     * ここまでに溜めたコマンドを今すぐ評価する(Batch自体は有効なまま)。successがnullptrなら、失敗した
+     * コマンドはcall()と同様にerror_policy()に従い、DEFAULTなら最初の失敗でErrorを送出する
+     * (残りのコマンドは破棄される)。
+     */
+    void flush(bool* success = nullptr);
+
+private:
+
+    Interpreter* interp_;
+
+};
+
+/**
+ * 繰り返し評価するTclスクリプト。本体を1つのTcl_Objとして保持し続けるため、初回評価時にTclが
+ * コンパイルしたバイトコードがそのオブジェクトに残り、2回目以降のrun()はコンパイルを省ける
+ * (call({"eval", script})は毎回新しい文字列objを作るため、その都度コンパイルし直しになる)。
+ * paramsを指定した場合は"apply {params body}"のラムダとして評価し、run()のargsをparamsに束縛する
+ * (ローカル変数はラムダ内に閉じる)。paramsなしの場合はグローバルレベルで評価し、argsは受け付けない。
+ * Style()と同じ流儀で、構築したスレッドのcurrent interpreterに束縛する。
+ */
+class Script : public InterpreterClient
+{
+
+public:
+
+    explicit Script(const std::string& body, const std::vector<std::string>& params = {});
+
+    /** スクリプトを評価して結果を返す。失敗時の扱い(success/error_policy())はcall()と同じ。 */
+    std::string run(const std::vector<ArgValue>& args = {}, bool* success = nullptr) const;
+
+protected:
+
+    Interpreter* interp() const override { return interp_; }
+
+    const char* type_name() const override { return "Script"; }
+
+private:
+
+    Interpreter* interp_;
+    TclValue     script_;     // paramsなしならスクリプト本体、ありなら{params body}のラムダ
+    bool         is_lambda_;
+
+};
+
+/**
+ * Tclのタイマ(Tcl_CreateTimerHandler)で直接動くタイマ。Widget::after()と異なり、Tclのafterコマンドを
+ * 経由せず、予約ごと(周期タイマなら1周期ごと)にTclコマンドを作ることもない。
+ * ハンドルはRAIIで、破棄(または別のTimerの代入)で予約を取り消す。取り消さずに手放す場合はdetach()を呼ぶ。
+ * 構築したスレッドのcurrent interpreter(Script()と同じ流儀)のイベントループ上で呼ばれ、取り消しも
+ * 同じスレッドから行う。reset_interpreter()やInterpreterの破棄でも取り消される。
+ */
+class Timer
+{
+
+public:
+
+    /** 何も予約していない空のハンドルを作る。 */
+    Timer();
+
+    Timer(const Timer&) = delete;
+
+    Timer& operator=(const Timer&) = delete;
+
+    Timer(Timer&& other) noexcept;
+
+    /** 自分の予約を取り消してから、otherの予約を引き継ぐ。 */
+    Timer& operator=(Timer&& other) noexcept;
+
+    ~Timer();
+
+    /** ms後に1回だけcallbackを呼ぶ。 */
+    static Timer once(int ms, std::function<void()> callback);
+
+    /**
+     * msごとにcallbackを呼び続ける(msは1以上に切り上げる)。予定時刻は単調増加の時計(steady_clock)で
+     * 初回の予約時刻からの倍数として決めるため、コールバックの実行時間やタイマの遅れが周期に
+     * 積み重ならない。1周期以上遅れた場合は、遅れた回を続けて呼ばずに次の予定時刻まで飛ばす。
+     */
+    static Timer every(int ms, std::function<void()> callback);
+
+    /** 予約を取り消す(コールバックの実行中に呼んでもよい)。取り消し済み・発火済みなら何もしない。 */
+    void cancel();
+
+    /** 予約を取り消さずにハンドルだけ手放す(以降はcancel()できない)。 */
+    void detach();
+
+    /** 予約が有効(onceなら未発火、everyなら取り消されていない)ならtrue。 */
+    bool active() const;
+
+private:
+
+    explicit Timer(std::shared_ptr<TimerState> state);
+
+    std::shared_ptr<TimerState> state_;
+
 };
 
+/**
+ * Animator::stats()の結果。フレーム時間は1フレーム分の処理(全更新処理とバッチの評価)にかかった時間。
+ */
+struct FrameStats
+{
+    std::size_t              frames;          // 処理したフレーム数
+    std::size_t              dropped_frames;  // 前のフレームの超過で予定時刻を過ぎたため、飛ばしたフレーム数
+    std::chrono::nanoseconds min_frame_time;  // フレーム時間の最小
+    std::chrono::nanoseconds avg_frame_time;  // フレーム時間の平均
+    std::chrono::nanoseconds p99_frame_time;  // 直近1024フレームのフレーム時間の99パーセンタイル
+    std::chrono::nanoseconds max_frame_time;  // フレーム時間の最大
+};
+
+/**
+ * 目標のフレームレートで、登録した更新処理を毎フレーム呼ぶアニメーションの駆動役。after()を自分で
+ * 予約し直す方式と異なり、予定時刻は単調増加の時計(steady_clock)で初回からの倍数として決めるため、
+ * 処理時間が周期に積み重ならない。処理が1フレーム以上超過した場合は、遅れたフレームを続けて処理せずに
+ * 飛ばし、その数をdropped_framesに数える。
+ * 各フレームの更新処理はtk::Batchの中で呼ぶため、Canvas::coords()等のsetterは1フレームにつき1回の
+ * ループでまとめて評価される。タイマはTimerを使い、構築したスレッドのcurrent interpreterのイベントループ
+ * 上で動く(Timerと同じく、reset_interpreter()で止まる)。
+ */
+class Animator
+{
+
+public:
+
+    /** fpsは目標のフレームレート(0以下なら60とする)。start()を呼ぶまでは動かない。 */
+    explicit Animator(double fps = 60.0);
+
+    Animator(const Animator&) = delete;
+
+    Animator& operator=(const Animator&) = delete;
+
+    Animator(Animator&& other) noexcept;
+
+    Animator& operator=(Animator&& other) noexcept;
+
+    /** 動いていれば止める。更新処理の中で破棄してもよい(そのフレームの残りの更新処理は呼ばれない)。 */
+    ~Animator();
+
+    /**
+     * 毎フレーム呼ぶ処理を登録し、remove()用のidを返す。登録順に呼ばれ、引数は前のフレームからの
+     * 経過時間(秒、最初のフレームは1周期分)。更新処理が投げた例外は他のコールバックと同じく
+     * set_callback_exception_handler()へ渡され、同じフレームの残りの更新処理は続けて呼ばれる。
+     */
+    std::size_t add(std::function<void(double)> update);
+
+    /** add()で登録した処理を解除する(更新処理の中で呼んでもよい)。 */
+    void remove(std::size_t id);
+
+    void start();
+
+    void stop();
+
+    bool running() const;
+
+    /** 目標のフレームレートを変える(0以下なら何もしない)。動いている場合は次のフレームから反映する。 */
+    void set_fps(double fps);
+
+    double fps() const;
+
+    FrameStats stats() const;
+
+    void reset_stats();
+
+private:
+
+    struct Impl;
+
+    std::shared_ptr<Impl> impl_;
+
+};
+
+/**
+ * 呼び出しスレッドのcurrent interpreter(Timerと同じ流儀)の次のアイドル時に、callbackを1回呼ぶ。
+ * 同じkeyで実行前に何度要求しても実行は1回にまとまり、最後に渡したcallbackが最初に要求した時点の
+ * 順番で呼ばれる(「何度要求されても次のアイドル時に1回だけ再描画する」用途)。キュー全体は1回の
+ * Tcl_DoWhenIdleでまとめて実行する。実行中に要求した分は、次のアイドル時に回る。
+ * 新しくキューに載せたらtrue、実行待ちの同じkeyにまとめたらfalseを返す。
+ * Widget::after_idle()と異なり、Tclのafterコマンドもコールバックごとのコマンドも使わない。
+ */
+bool schedule_idle(const std::string& key, std::function<void()> callback);
+
+/** schedule_idle()で要求した実行待ちのkeyを取り消す。取り消したらtrue、実行待ちで無ければfalseを返す。 */
+bool cancel_idle(const std::string& key);
+
 class Object
 {
 
@@ -364,6 +1053,11 @@ protected:
 
     std::string  name_;
 
+    // コピーしたVarどうしで共有する、trace()で張った変数トレースの持ち主。最後のVarの破棄でトレースを外す。
+    struct TraceState;
+
+    std::shared_ptr<TraceState> trace_state_;
+
     // 派生クラスはinterp_->set_var/get_var/trace_varを直接呼ばず、これらのラッパー経由で
     // 呼び出す(未初期化/既に破棄されたinterp_に対するガードはInterpreterClient::checked_interp()に集約)。
     void trace_var(std::function<void(const std::string&)> callback);
@@ -372,6 +1066,11 @@ protected:
 
     void trace_var(std::function<void(const double&)> callback);
 
+private:
+
+    // trace_var()でトレースを張ったことをtrace_state_に記録する。
+    void remember_trace(Interpreter* p);
+
 };
 
 class StringVar : public Var
@@ -451,7 +1150,7 @@ public:
      * 同じ流儀。かつては`const Widget& parent`を取っていたが、実際には参照していなかった
      * ため廃止した)。current_interp()はInterpreterが無ければその場で生成する。
      */
-    explicit PhotoImage(const std::map<std::string, ArgValue>& options = {});
+    explicit PhotoImage(const Options& options = {});
 
     const std::string& name() const;
 
@@ -464,7 +1163,10 @@ public:
 
     /** 画素データを書き込む(Python PhotoImage.put(data, to=...)相当)。dataは"{r g b} {r g b} ..."形式のTclリスト
      *  文字列(行ごとに波括弧で囲んだ画素値の並び)をそのまま渡す(整形はユーザー側で行う簡略版)。 */
-    PhotoImage& put(const std::string& data, const std::map<std::string, ArgValue>& options = {});
+    PhotoImage& put(const std::string& data, const Options& options = {});
+
+    /** 借用したバッファをそのまま渡す版(画素データはTcl_Objへ1回だけコピーされる)。 */
+    PhotoImage& put(const StringRef& data, const Options& options = {});
 
     /** 指定座標の画素値を"r g b"形式の文字列で返す(Python PhotoImage.get(x, y)相当)。 */
     std::string get(int x, int y) const;
@@ -473,7 +1175,7 @@ public:
     PhotoImage& blank();
 
     /** sourceの内容を(options指定範囲で)自分自身へ取り込む(Tclの"imageName copy source"に忠実な版)。 */
-    PhotoImage& copy_from(const PhotoImage& source, const std::map<std::string, ArgValue>& options = {});
+    PhotoImage& copy_from(const PhotoImage& source, const Options& options = {});
 
     /** 自分自身の複製を新規PhotoImageとして作成して返す(Python PhotoImage.copy()相当)。 */
     PhotoImage copy() const;
@@ -510,7 +1212,7 @@ class BitmapImage : public Object, public InterpreterClient
 {
 public:
     /** PhotoImage(options)と同じ理由・同じ流儀(current_interp()に束縛。無ければその場で生成される)。 */
-    explicit BitmapImage(const std::map<std::string, ArgValue>& options = {});
+    explicit BitmapImage(const Options& options = {});
 
     const std::string& name() const;
 
@@ -554,7 +1256,7 @@ public:
      * 生成後に再設定可能な通常のオプションについては、生成時に埋め込んでも生成後にconfigureするのと
      * 最終的な状態は変わらない。
      */
-    Widget(const Widget& parent, const std::string &type, const std::string& name="", const std::map<std::string, ArgValue>& options={});
+    Widget(const Widget& parent, const std::string &type, const std::string& name="", const Options& options={});
 
     // コピーすると「親と同じ型を1引数で渡す」呼び出しが子ウィジェット生成と衝突して
     // 曖昧になり、意図せずコピーコンストラクタが選ばれてしまう事故を防ぐため禁止する
@@ -583,41 +1285,48 @@ public:
      */
     const Widget& as_parent() const { return *this; }
 
-    Widget& pack(const std::map<std::string, ArgValue> &options = {});
+    Widget& pack(const Options& options = {});
 
     Widget& pack_forget();
 
-    Widget& grid(const std::map<std::string, ArgValue> &options = {});
+    Widget& grid(const Options& options = {});
 
     Widget& grid_forget();
 
-    Widget& place(const std::map<std::string, ArgValue> &option = {});
+    Widget& place(const Options& option = {});
 
     Widget& place_forget();
 
     Widget& config(const std::string& name, const ArgValue& value);
 
-    Widget& config(const std::map<std::string, ArgValue> &option);
+    Widget& config(const Options& option);
 
-    Widget& grid_rowconfigure(int row, const std::map<std::string, ArgValue>& options);
+    Widget& grid_rowconfigure(int row, const Options& options);
 
-    Widget& grid_columnconfigure(int column, const std::map<std::string, ArgValue>& options);
+    Widget& grid_columnconfigure(int column, const Options& options);
 
     std::string cget(const std::string& name) const;
 
-    Widget& bind(const std::string& event, std::function<void(const Event&)> callback);
+    /**
+     * eventに処理を登録する。fieldsでEventに読み込むフィールドを絞れる(EventField参照)。
+     * coalesceをCoalesce::LATESTにすると、頻繁なイベントを次のアイドル時に1回にまとめて呼ぶ(Coalesce参照)。
+     */
+    Widget& bind(const std::string& event, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE);
 
     /** event に対して bind() で登録した処理を解除する(Python Misc.unbind()相当の簡略版)。 */
     Widget& unbind(const std::string& event);
 
     /** アプリケーション内の全ウィジェットに対するグローバルなバインドを設定する(Python Misc.bind_all()相当)。 */
-    Widget& bind_all(const std::string& event, std::function<void(const Event&)> callback);
+    Widget& bind_all(const std::string& event, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE);
 
     /** bind_all()で登録した処理を解除する(Python Misc.unbind_all()相当の簡略版)。 */
     Widget& unbind_all(const std::string& event);
 
     /** 指定クラス名(winfo_class()が返す名前)の全ウィジェットに対するバインドを設定する(Python Misc.bind_class()相当)。 */
-    Widget& bind_class(const std::string& class_name, const std::string& event, std::function<void(const Event&)> callback);
+    Widget& bind_class(const std::string& class_name, const std::string& event, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE);
+
+    /** bind_class()で登録した処理を解除する(Python Misc.unbind_class()相当)。 */
+    Widget& unbind_class(const std::string& class_name, const std::string& event);
 
     std::string after(const int& ms, std::function<void()> callback);
 
@@ -634,7 +1343,7 @@ public:
     void update_idletasks();
 
     /** 合成イベントを発火する(Python Misc.event_generate()相当)。 */
-    void event_generate(const std::string& event, const std::map<std::string, ArgValue>& options = {});
+    void event_generate(const std::string& event, const Options& options = {});
 
     int winfo_width() const;
 
@@ -713,6 +1422,9 @@ public:
     /** クリップボードに文字列を追加する(Python Misc.clipboard_append()相当)。 */
     void clipboard_append(const std::string& text);
 
+    /** 借用したバッファをそのまま渡す版(Tcl_Objへ1回だけコピーされる)。 */
+    void clipboard_append(const StringRef& text);
+
     /** クリップボードの内容を取得する(Python Misc.clipboard_get()相当)。 */
     std::string clipboard_get() const;
 
@@ -804,7 +1516,16 @@ protected:
     {
         Interpreter* interp = nullptr;
         std::string  full_name;
-        int          after_id = 0;
+        Tcl_Obj*     path_obj = nullptr; // full_nameのTcl_Obj(参照カウント保持、Widget::path_obj()が遅延生成)
+        WidgetCommandCache* command_cache = nullptr; // ウィジェットコマンドの解決結果(Widget::exec_direct()が遅延生成)
+
+        Impl() = default;
+
+        Impl(const Impl&) = delete;
+
+        Impl& operator=(const Impl&) = delete;
+
+        ~Impl();
     };
 
 public:
@@ -833,18 +1554,32 @@ protected:
 
     const char* type_name() const override { return "Widget"; }
 
+    Tcl_Obj* path_obj() const override;
+
+    /**
+     * exec()と同じだが、words[0]がこのウィジェット自身のコマンド(full_name())である呼び出しに限り、
+     * 初回に解決したコマンド情報(Tcl_CmdInfo)をキャッシュし、以降はTcl_EvalObjvのコマンド名解決を
+     * 経由せずそのobjProcを直接呼ぶ。Canvas::coords/move等、アニメーションで毎フレーム呼ばれる
+     * 経路向け。キャッシュはウィジェットの破棄(コマンドの削除/rename)を検知して無効化される。
+     * tk::Batch中やコマンドが未解決の場合はexec()と同じ経路に戻る。
+     */
+    bool exec_direct(const std::vector<ArgValue>& words, bool* success = nullptr) const;
+
     // register_*_callbackはimpl_->interp->register_*_callbackを直接呼ばず、これらの
     // ラッパー経由で呼び出す(impl_->interpが未初期化/既に破棄されている場合のガードは
-    // InterpreterClient::checked_interp()に集約されている)。
-    void register_void_callback(const std::string& name, std::function<void()> callback) const;
+    // InterpreterClient::checked_interp()に集約されている)。コールバックはこのウィジェットの
+    // 破棄時に解放され、戻り値はTclに渡すコマンド名(未初期化なら空文字列)。roleはこのウィジェット
+    // 内でのコールバックの役割("command"、"bind <Enter>"等)で、同じroleの登録は前のコールバックを
+    // 置き換える。空文字列なら常に新しいコールバックとして追加する(メニュー項目等)。
+    std::string register_void_callback(const std::string& role, std::function<void()> callback) const;
 
-    void register_string_callback(const std::string& name, std::function<void(const std::string&)> callback) const;
+    std::string register_string_callback(const std::string& role, std::function<void(const std::string&)> callback) const;
 
-    void register_double_callback(const std::string& name, std::function<void(const double&)> callback) const;
+    std::string register_double_callback(const std::string& role, std::function<void(const double&)> callback) const;
 
-    void register_event_callback(const std::string& name, std::function<void(const Event&)> callback) const;
+    std::string register_event_callback(const std::string& role, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE) const;
 
-    void register_bool_callback(const std::string& name, std::function<bool(const std::string&)> callback) const;
+    std::string register_bool_callback(const std::string& role, std::function<bool(const std::string&)> callback) const;
 };
 
 class Tk : public Widget
@@ -923,7 +1658,7 @@ public:
 
     Frame() = default;
 
-    explicit Frame(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Frame(const Widget& parent, const Options& options = {});
 
     Frame& width(const int &width);
 
@@ -942,7 +1677,7 @@ public:
 
     Toplevel() = default;
 
-    explicit Toplevel(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Toplevel(const Widget& parent, const Options& options = {});
 
     Toplevel& title(const std::string &title_text);
 
@@ -1010,7 +1745,7 @@ public:
 
     Button() = default;
 
-    explicit Button(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Button(const Widget& parent, const Options& options = {});
 
     Button& width(const int& width);
 
@@ -1034,9 +1769,9 @@ public:
 
     Canvas() = default;
 
-    explicit Canvas(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Canvas(const Widget& parent, const Options& options = {});
 
-    Canvas& itemconfig(const std::string& id_or_tag, const std::map<std::string, ArgValue>& options);
+    Canvas& itemconfig(const std::string& id_or_tag, const Options& options);
 
     /** itemconfigの読み取り版。 */
     std::string itemcget(const std::string& id_or_tag, const std::string& option) const;
@@ -1045,30 +1780,36 @@ public:
     std::vector<int> bbox(const std::string& id_or_tag) const;
 
     /** 図形タグ/ID単位のイベントバインド。 */
-    Canvas& tag_bind(const std::string& id_or_tag, const std::string& event, std::function<void(const Event&)> callback);
+    Canvas& tag_bind(const std::string& id_or_tag, const std::string& event, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE);
 
     /** tag_bindで登録したバインドを解除する。 */
     Canvas& tag_unbind(const std::string& id_or_tag, const std::string& event);
 
-    std::string create_line(const std::vector<std::array<double, 2>>& points, const std::map<std::string, ArgValue>& options = {});
+    std::string create_line(const std::vector<std::array<double, 2>>& points, const Options& options = {});
 
-    std::string create_line(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options = {});
+    /** 構築済みの座標リスト(TclValue、"x1 y1 x2 y2 ..."のリスト)をそのまま渡す版。 */
+    std::string create_line(const TclValue& coords, const Options& options = {});
 
-    std::string create_oval(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options = {});
+    std::string create_line(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options = {});
 
-    std::string create_rectangle(const int& x1, const int& y1, const int& x2, const int& y2, const std::map<std::string, ArgValue>& options = {});
+    std::string create_oval(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options = {});
 
-    std::string create_text(const int& x, const int& y, const std::map<std::string, ArgValue>& options = {});
+    std::string create_rectangle(const int& x1, const int& y1, const int& x2, const int& y2, const Options& options = {});
 
-    std::string create_polygon(const std::vector<int>& coords, const std::map<std::string, ArgValue>& options = {}); 
+    std::string create_text(const int& x, const int& y, const Options& options = {});
+
+    std::string create_polygon(const std::vector<int>& coords, const Options& options = {}); 
+
+    /** 構築済みの座標リスト(TclValue、"x1 y1 x2 y2 ..."のリスト)をそのまま渡す版。 */
+    std::string create_polygon(const TclValue& coords, const Options& options = {});
     
-    std::string create_arc(int x1, int y1, int x2, int y2, const std::map<std::string, ArgValue>& options = {}); 
+    std::string create_arc(int x1, int y1, int x2, int y2, const Options& options = {}); 
     
-    std::string create_image(int x, int y, const std::map<std::string, ArgValue>& options = {});
+    std::string create_image(int x, int y, const Options& options = {});
 
-    std::string create_bitmap(int x, int y, const std::map<std::string, ArgValue>& options = {});
+    std::string create_bitmap(int x, int y, const Options& options = {});
 
-    std::string create_window(int x, int y, const Widget& widget, const std::map<std::string, ArgValue>& options = {});
+    std::string create_window(int x, int y, const Widget& widget, const Options& options = {});
 
     std::vector<std::string> find_overlapping(int x1, int y1, int x2, int y2) const;
 
@@ -1112,8 +1853,12 @@ public:
 
     Canvas& scale(const std::string& id_or_tag, const int& x, const int& y, const double& xscale, const double& yscale);
 
+    /** 座標列は要素ごとの語ではなく1つのTclリストとして渡す(Tkの"coords tagOrId coordList"形式)。 */
     Canvas& coords(const std::string& id_or_tag, const std::vector<int>& coords);
 
+    /** 構築済みの座標リスト(TclValue)をそのまま渡す版。毎フレーム同じ座標列を使い回す場合向け。 */
+    Canvas& coords(const std::string& id_or_tag, const TclValue& coords);
+
     Canvas& erase(const std::string& id_or_tag);
 
     Canvas& width(const int &width);
@@ -1124,7 +1869,7 @@ public:
      * 描画内容をPostScript形式で書き出す(Python Canvas.postscript()相当)。"file"オプションを指定しなければ
      * 生成したPostScriptデータを文字列で返す(指定した場合はファイルへ書き出し、戻り値は空文字列)。
      */
-    std::string postscript(const std::map<std::string, ArgValue>& options = {});
+    std::string postscript(const Options& options = {});
 
 };
 
@@ -1137,7 +1882,7 @@ public:
 
     Checkbutton() = default;
 
-    explicit Checkbutton(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Checkbutton(const Widget& parent, const Options& options = {});
 
     Checkbutton& text(const std::string& text);
 
@@ -1164,7 +1909,7 @@ public:
 
     Entry() = default;
 
-    explicit Entry(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Entry(const Widget& parent, const Options& options = {});
 
     /**
      * name()を読むだけで保持はしない(Tkの-textvariableはウィジェットの表示テキストとTcl変数を
@@ -1218,7 +1963,7 @@ public:
 
     Label() = default;
 
-    explicit Label(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Label(const Widget& parent, const Options& options = {});
 
     Label& text(const std::string &text);
 };
@@ -1233,7 +1978,7 @@ public:
 
     LabelFrame() = default;
 
-    explicit LabelFrame(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit LabelFrame(const Widget& parent, const Options& options = {});
 
     LabelFrame& width(const int& width);
 
@@ -1251,7 +1996,7 @@ public:
 
     Listbox() = default;
 
-    explicit Listbox(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Listbox(const Widget& parent, const Options& options = {});
 
     /** indexはEND/ACTIVE等のシンボリック定数、または数値の文字列表現("0"等)で指定する。 */
     Listbox& insert(const std::string& index, const std::string& item);
@@ -1307,36 +2052,36 @@ public:
 
     Menu() = default;
 
-    explicit Menu(const Widget& parent, const std::map<std::string, ArgValue>& options = {}); 
+    explicit Menu(const Widget& parent, const Options& options = {}); 
     
     /**
      * callbackを指定すると、クリック時に呼ばれるコールバックを"-command"として自動登録する
      * (Python Menu.add_command(command=callback)相当)。省略時(既定のnullptr)は本家Python同様
      * commandオプション無しの項目になる。
      */
-    Menu& add_command(const std::map<std::string, ArgValue>& options, std::function<void()> callback = nullptr);
+    Menu& add_command(const Options& options, std::function<void()> callback = nullptr);
 
-    Menu& add_cascade(const std::map<std::string, ArgValue>& options);
+    Menu& add_cascade(const Options& options);
 
     Menu& add_separator();
 
     /** callbackはON/OFF切り替え時に呼ばれる(Python Menu.add_checkbutton(command=callback)相当)。 */
-    Menu& add_checkbutton(const std::map<std::string, ArgValue>& options, std::function<void()> callback = nullptr);
+    Menu& add_checkbutton(const Options& options, std::function<void()> callback = nullptr);
 
     /** callbackは選択時に呼ばれる(Python Menu.add_radiobutton(command=callback)相当)。 */
-    Menu& add_radiobutton(const std::map<std::string, ArgValue>& options, std::function<void()> callback = nullptr);
+    Menu& add_radiobutton(const Options& options, std::function<void()> callback = nullptr);
 
     /**
      * item_typeは"command"/"cascade"/"checkbutton"/"radiobutton"/"separator"のいずれか(Tclの"menu insert"にそのまま対応)。
      * callbackはcommand/checkbutton/radiobutton型の場合のみ意味を持つ(cascade/separatorに指定するとTclがエラーになる)。
      */
-    Menu& insert(const std::string& index, const std::string& item_type, const std::map<std::string, ArgValue>& options = {}, std::function<void()> callback = nullptr);
+    Menu& insert(const std::string& index, const std::string& item_type, const Options& options = {}, std::function<void()> callback = nullptr);
 
     /**
      * 指定indexの項目の設定を変更する(Python Menu.entryconfigure()相当)。
      * callbackを指定すると、その項目の"-command"を差し替える。
      */
-    Menu& entryconfigure(const std::string& index, const std::map<std::string, ArgValue>& options, std::function<void()> callback = nullptr);
+    Menu& entryconfigure(const std::string& index, const Options& options, std::function<void()> callback = nullptr);
 
     /** patternに一致する項目の数値indexを返す。一致が無ければ-1(Python Menu.index()相当)。 */
     int index(const std::string& pattern) const;
@@ -1422,7 +2167,7 @@ public:
     
     PanedWindow& orient(const std::string& dir); 
     
-    PanedWindow& add(const Widget& child, const std::map<std::string, ArgValue>& options = {}); 
+    PanedWindow& add(const Widget& child, const Options& options = {}); 
     
     PanedWindow& forget(const Widget& child); 
 
@@ -1437,7 +2182,7 @@ public:
 
     Radiobutton() = default;
 
-    explicit Radiobutton(const Widget& parent, const std::map<std::string, ArgValue>& options = {}); 
+    explicit Radiobutton(const Widget& parent, const Options& options = {}); 
     
     Radiobutton& text(const std::string& text); 
     
@@ -1463,7 +2208,7 @@ public:
 
     Scale() = default;
 
-    explicit Scale(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Scale(const Widget& parent, const Options& options = {});
 
     Scale& from(double val);
 
@@ -1490,7 +2235,7 @@ public:
 
     Scrollbar() = default;
 
-    explicit Scrollbar(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Scrollbar(const Widget& parent, const Options& options = {});
 
     Scrollbar& orient(const std::string& dir);
 
@@ -1509,7 +2254,7 @@ public:
 
     Spinbox() = default;
 
-    explicit Spinbox(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Spinbox(const Widget& parent, const Options& options = {});
 
     Spinbox& from(double val);
 
@@ -1540,10 +2285,13 @@ public:
 
     Text() = default;
 
-    explicit Text(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Text(const Widget& parent, const Options& options = {});
 
     Text& insert(const std::string& index, const std::string& text);
 
+    /** 借用したバッファをそのまま渡す版。ログ等の大きなチャンクを追記する場合、本文はTcl_Objへ1回だけコピーされる。 */
+    Text& insert(const std::string& index, const StringRef& text);
+
     std::string get(const std::string& start, const std::string& end = "end") const ;
 
     Text& erase(const std::string& start, const std::string& end = "end");
@@ -1567,13 +2315,13 @@ public:
 
     Text& tag_remove(const std::string& tag, const std::string& start, const std::string& end); 
 
-    Text& tag_config(const std::string& tag, const std::map<std::string, ArgValue>& options);
+    Text& tag_config(const std::string& tag, const Options& options);
 
     Text& mark_set(const std::string& mark, const std::string& index); 
     
     Text& mark_unset(const std::string& mark);
 
-    std::string search(const std::string& pattern, const std::string& index, const std::map<std::string, ArgValue>& options = {});
+    std::string search(const std::string& pattern, const std::string& index, const Options& options = {});
 
     /** 指定位置が見えるようスクロールする。 */
     Text& see(const std::string& index);
@@ -1618,10 +2366,10 @@ public:
     std::string dump(const std::string& index1, const std::string& index2 = "") const;
 
     /** indexの位置に画像を埋め込み、生成された画像アイテム名を返す(Python Text.image_create()相当)。 */
-    std::string image_create(const std::string& index, const std::map<std::string, ArgValue>& options = {});
+    std::string image_create(const std::string& index, const Options& options = {});
 
     /** indexの位置に他のウィジェットを埋め込む(Python Text.window_create()相当)。 */
-    Text& window_create(const std::string& index, const Widget& window, const std::map<std::string, ArgValue>& options = {});
+    Text& window_create(const std::string& index, const Widget& window, const Options& options = {});
 
 };
 
@@ -1641,10 +2389,10 @@ public:
      * 呼び出しスレッドのcurrent interpreterに束縛して実体を作る(StringVar()と同じ理由・
      * 同じ流儀でparentを廃止した。current_interp()はInterpreterが無ければその場で生成する)。
      */
-    explicit Font(const std::map<std::string, ArgValue>& option = {},
+    explicit Font(const Options& option = {},
                   const std::string& name = "", bool exists = false);
 
-    Font& config(const std::map<std::string, ArgValue>& option);
+    Font& config(const Options& option);
 
     Font& size(const int& size);
 
@@ -1718,7 +2466,7 @@ public:
     Style();
 
     /** 指定style(例: "TButton"、全体既定は"." )の既定オプションを設定する。 */
-    Style& configure(const std::string& style_name, const std::map<std::string, ArgValue>& options);
+    Style& configure(const std::string& style_name, const Options& options);
 
     /**
      * 状態依存のオプションを設定する。各オプションの値は"state1 value1 state2 value2 ..."を
@@ -1784,7 +2532,7 @@ public:
 
     Button() = default;
 
-    explicit Button(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Button(const Widget& parent, const Options& options = {});
 
     Button& width(const int& width);
 
@@ -1810,7 +2558,7 @@ public:
 
     Checkbutton() = default;
 
-    explicit Checkbutton(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Checkbutton(const Widget& parent, const Options& options = {});
 
     Checkbutton& text(const std::string& text);
 
@@ -1834,7 +2582,7 @@ public:
 
     Combobox() = default;
 
-    explicit Combobox(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Combobox(const Widget& parent, const Options& options = {});
 
     Combobox& values(const std::vector<std::string>& items);
 
@@ -1876,7 +2624,7 @@ public:
 
     Entry() = default;
 
-    explicit Entry(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Entry(const Widget& parent, const Options& options = {});
 
     /** name()を読むだけで保持はしない。右辺値の一時変数を弾くためあえて非constの参照にしている。 */
     Entry& textvariable(StringVar& var);
@@ -1928,7 +2676,7 @@ public:
 
     Frame() = default;
 
-    explicit Frame(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Frame(const Widget& parent, const Options& options = {});
 
     Frame& width(const int &width);
 
@@ -1945,7 +2693,7 @@ public:
 
     Notebook() = default;
 
-    explicit Notebook(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Notebook(const Widget& parent, const Options& options = {});
 
     Notebook& add_tab(const Widget& child, const std::string& label);
 
@@ -1956,7 +2704,7 @@ public:
     std::string select() const;
 
     /** タブの設定を変更する(Python Notebook.tab(tab_id, **kw)相当)。 */
-    Notebook& tab(const std::string& tab_id, const std::map<std::string, ArgValue>& options);
+    Notebook& tab(const std::string& tab_id, const Options& options);
 
     /** タブの設定値を1つ読み取る(Python Notebook.tab(tab_id, option)相当)。 */
     std::string tab(const std::string& tab_id, const std::string& option) const;
@@ -1983,11 +2731,11 @@ public:
 
     PanedWindow() = default;
 
-    explicit PanedWindow(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit PanedWindow(const Widget& parent, const Options& options = {});
 
     PanedWindow& orient(const std::string& dir);
 
-    PanedWindow& add(const Widget& child, const std::map<std::string, ArgValue>& options = {});
+    PanedWindow& add(const Widget& child, const Options& options = {});
 
     PanedWindow& forget(const Widget& child);
 
@@ -2010,7 +2758,7 @@ public:
 
     Label() = default;
 
-    explicit Label(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Label(const Widget& parent, const Options& options = {});
 
     Label& text(const std::string &text);
 
@@ -2029,7 +2777,7 @@ public:
 
     Labelframe() = default;
 
-    explicit Labelframe(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Labelframe(const Widget& parent, const Options& options = {});
 
     Labelframe& text(const std::string& text);
 };
@@ -2044,7 +2792,7 @@ public:
 
     Menubutton() = default;
 
-    explicit Menubutton(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Menubutton(const Widget& parent, const Options& options = {});
 
     Menubutton& menu(Menu* menu);
 };
@@ -2057,7 +2805,7 @@ public:
 
     Progressbar() = default;
 
-    explicit Progressbar(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Progressbar(const Widget& parent, const Options& options = {});
 
     Progressbar& mode(const std::string& mode);
 
@@ -2080,7 +2828,7 @@ public:
 
     Radiobutton() = default;
 
-    explicit Radiobutton(const Widget& parent, const std::map<std::string, ArgValue>& options = {}); 
+    explicit Radiobutton(const Widget& parent, const Options& options = {}); 
     
     Radiobutton& text(const std::string& text); 
     
@@ -2105,7 +2853,7 @@ public:
 
     Separator() = default;
 
-    explicit Separator(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Separator(const Widget& parent, const Options& options = {});
 };
 
 class Scale : public Widget
@@ -2117,7 +2865,7 @@ public:
 
     Scale() = default;
 
-    explicit Scale(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Scale(const Widget& parent, const Options& options = {});
 
     Scale& from(double val);
 
@@ -2144,7 +2892,7 @@ public:
 
     Scrollbar() = default;
 
-    explicit Scrollbar(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Scrollbar(const Widget& parent, const Options& options = {});
 
     Scrollbar& orient(const std::string& dir);
 
@@ -2163,7 +2911,7 @@ public:
 
     Spinbox() = default;
 
-    explicit Spinbox(const Widget& parent, const std::map<std::string, ArgValue>& options = {}); 
+    explicit Spinbox(const Widget& parent, const Options& options = {}); 
     
     Spinbox& from(double val); 
     
@@ -2189,7 +2937,7 @@ public:
 
     Sizegrip() = default;
 
-    explicit Sizegrip(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Sizegrip(const Widget& parent, const Options& options = {});
 };
 
 class Treeview : public Widget
@@ -2200,21 +2948,21 @@ public:
 
     Treeview() = default;
 
-    explicit Treeview(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit Treeview(const Widget& parent, const Options& options = {});
 
-    Treeview& insert(const std::string& parent, const std::string& index, const std::string& iid, const std::map<std::string, ArgValue>& options = {});
+    Treeview& insert(const std::string& parent, const std::string& index, const std::string& iid, const Options& options = {});
 
     Treeview& erase(const std::string& iid);
 
-    Treeview& item(const std::string& iid, const std::map<std::string, ArgValue>& options = {});
+    Treeview& item(const std::string& iid, const Options& options = {});
     
     /**
      * callbackを指定すると、列ヘッダクリック時に呼ばれるコールバックを"-command"として自動登録する
      * (Python Treeview.heading(column, command=callback)相当。「ヘッダクリックでソート」の定番パターン用)。
      */
-    Treeview& heading(const std::string& column, const std::map<std::string, ArgValue>& options = {}, std::function<void()> callback = nullptr);
+    Treeview& heading(const std::string& column, const Options& options = {}, std::function<void()> callback = nullptr);
 
-    Treeview& column(const std::string& column, const std::map<std::string, ArgValue>& options = {});
+    Treeview& column(const std::string& column, const Options& options = {});
 
     std::vector<std::string> selection() const;
 
@@ -2264,9 +3012,9 @@ public:
     
     std::string focus() const;
 
-    Treeview& tag_configure(const std::string& tag, const std::map<std::string, ArgValue>& options);
+    Treeview& tag_configure(const std::string& tag, const Options& options);
 
-    Treeview& tag_bind(const std::string& tag, const std::string& event, std::function<void(const Event&)> callback);
+    Treeview& tag_bind(const std::string& tag, const std::string& event, std::function<void(const Event&)> callback, EventField fields = EventField::ALL, Coalesce coalesce = Coalesce::NONE);
 
     /** 指定タグが付与されている行のiid一覧を返す(Python Treeview.tag_has()相当)。 */
     std::vector<std::string> tag_has(const std::string& tag) const;
@@ -2282,7 +3030,7 @@ public:
 
 namespace colorchooser
 {
-    std::string askcolor(const std::map<std::string, ArgValue>& options = {});
+    std::string askcolor(const Options& options = {});
 } // colorchooser
 
 namespace filedialog
@@ -2303,14 +3051,14 @@ namespace filedialog
  * })}});
  * ```
  */
-std::string askopenfile(const std::map<std::string, ArgValue>& options = {});
+std::string askopenfile(const Options& options = {});
 
 /** 複数選択(-multiple 1)を指定してファイル選択ダイアログを表示し、選択されたパス一覧を返す(Python askopenfilenames()相当)。 */
-std::vector<std::string> askopenfilenames(const std::map<std::string, ArgValue>& options = {});
+std::vector<std::string> askopenfilenames(const Options& options = {});
 
-std::string asksaveasfilename(const std::map<std::string, ArgValue>& options = {});
+std::string asksaveasfilename(const Options& options = {});
 
-std::string askdirectory(const std::map<std::string, ArgValue>& options = {});
+std::string askdirectory(const Options& options = {});
 
 } // filedialog
 
@@ -191,7 +191,7 @@ Calendar& Calendar::command(std::function<void(int, int, int)> callback)
     return *this;
 }
 
-ScrolledText::ScrolledText(const Widget& parent, const std::map<std::string, ArgValue>& options)
+ScrolledText::ScrolledText(const Widget& parent, const Options& options)
     : Widget(parent, "frame", "scrolledtext")
 {
     text_      = Text(*this, options);
@@ -399,30 +399,28 @@ void use_sv_ttk_theme(bool dark)
         if (!tmp) tmp = std::getenv("TMPDIR");
         std::string base_dir = std::string(tmp ? tmp : "/tmp") + "/cpp_tk_sv_ttk";
 
-        // 埋め込みアセットを書き出す共通プロシージャを1度だけ定義する。このスクリプト文字列は
-        // cpp_tk自身が書いた固定文字列であり、埋め込みアセットの中身(content引数)は文字列展開
-        // せず単なる引数値として渡すため、特殊文字によるインジェクションの懸念はない。
-        style.call({"eval",
-            "proc cpp_tk_sv_ttk_write {path content is_binary} {"
-            "  file mkdir [file dirname $path];"
-            "  if {$is_binary} {"
-            "    set ch [open $path wb];"
-            "    fconfigure $ch -translation binary;"
-            "    puts -nonewline $ch [binary decode base64 $content];"
-            "  } else {"
-            "    set ch [open $path w];"
-            "    puts -nonewline $ch $content;"
-            "  };"
-            "  close $ch"
-            "}"
-        });
+        // 埋め込みアセットを書き出すスクリプト。tk::Scriptのラムダとして1度だけコンパイルし、全ファイルで
+        // 使い回す(グローバルなプロシージャも残さない)。このスクリプト文字列はcpp_tk自身が書いた固定文字列
+        // であり、埋め込みアセットの中身(content引数)は文字列展開せず単なる引数値として渡すため、特殊文字に
+        // よるインジェクションの懸念はない。
+        Script write_file(
+            "file mkdir [file dirname $path];"
+            "if {$is_binary} {"
+            "  set ch [open $path wb];"
+            "  fconfigure $ch -translation binary;"
+            "  puts -nonewline $ch [binary decode base64 $content];"
+            "} else {"
+            "  set ch [open $path w];"
+            "  puts -nonewline $ch $content;"
+            "};"
+            "close $ch",
+            {"path", "content", "is_binary"});
 
         for (std::size_t i = 0; i < detail::sv_ttk_files_count; ++i)
         {
             const detail::EmbeddedFile& f = detail::sv_ttk_files[i];
             std::string full_path = base_dir + "/" + f.relative_path;
-            std::string content(f.content, f.length);
-            style.call({"cpp_tk_sv_ttk_write", full_path, content, f.binary_base64 ? "1" : "0"});
+            write_file.run({full_path, StringRef(f.content, f.length), f.binary_base64 ? "1" : "0"});
         }
 
         style.call({"source", base_dir + "/sv.tcl"});
@@ -437,8 +435,9 @@ void use_sv_ttk_theme(bool dark)
     // event generateによる発火は初回呼び出し直後だと反映されないことがあったため(要因未特定)、
     // "."自身の配色を決めるconfigure_colorsは直接呼び出して確実に適用する。event generateは
     // 既存のEntry/Combobox/Spinbox/Menu等(configure_colors以外の<<ThemeChanged>>バインド先)への
-    // 反映のためあわせて発火しておく。
-    style.call({"eval", "configure_colors"});
+    // 反映のためあわせて発火しておく。configure_colorsは単一のコマンドなので、evalで毎回スクリプトとして
+    // コンパイルさせずにコマンドとして直接呼ぶ。
+    style.call({"configure_colors"});
     style.call({"event", "generate", ".", "<<ThemeChanged>>"});
 }
 
@@ -28,7 +28,7 @@ public:
 
     ScrolledText() = default;
 
-    explicit ScrolledText(const Widget& parent, const std::map<std::string, ArgValue>& options = {});
+    explicit ScrolledText(const Widget& parent, const Options& options = {});
 
     /** 内部のTextウィジェットへの参照。insert/get/tag_*等のText固有の操作はこちら経由で行う。 */
     Text& text();
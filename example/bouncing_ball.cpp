@@ -0,0 +1,117 @@
+/**
+ * @file bouncing_ball.cpp
+ * @author okano tomoyuki (okano.development@gmail.com)
+ * @brief 壁で跳ね返るボールのサンプル(tk::Animatorの使用例)
+ *
+ * ボールの位置をtk::Animatorの毎フレームの経過時間(dt)から求めるため、フレームが遅れても
+ * ボールの速さは変わりません。下のラベルには1秒ごとにフレーム時間の統計を表示し、ボタンで
+ * アニメーションを止めたり再開したりできます。
+ *
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "cpp_tk.hpp"
+
+int main()
+{
+    namespace tk = cpp_tk;
+
+    constexpr auto WIDTH  = 400;
+    constexpr auto HEIGHT = 300;
+    constexpr auto RADIUS = 15;
+
+    auto app = tk::Tk();
+    app.title("Bouncing Ball");
+
+    auto canvas = tk::Canvas(app);
+    canvas
+        .width(WIDTH)
+        .height(HEIGHT)
+        .config({
+            {"bg", "white"},
+            {"highlightthickness", "0"}
+        })
+        .pack();
+
+    auto ball = canvas.create_oval(0, 0, RADIUS * 2, RADIUS * 2, {{"fill", "orange"}});
+
+    auto status = tk::Label(app);
+    status.pack();
+
+    // ボールの位置と速度(ピクセル/秒)
+    auto x  = double(WIDTH / 2);
+    auto y  = double(HEIGHT / 2);
+    auto vx = 180.0;
+    auto vy = 120.0;
+
+    auto animator = tk::Animator(60.0);
+    animator.add([&](double dt) {
+        x += vx * dt;
+        y += vy * dt;
+
+        // 壁を越えたら壁の位置に戻し、壁から離れる向きにする(dtが大きいフレームでも外に出たままにしない)
+        if (x < RADIUS)
+        {
+            x  = RADIUS;
+            vx = std::fabs(vx);
+        }
+        else if (x > WIDTH - RADIUS)
+        {
+            x  = WIDTH - RADIUS;
+            vx = -std::fabs(vx);
+        }
+        if (y < RADIUS)
+        {
+            y  = RADIUS;
+            vy = std::fabs(vy);
+        }
+        else if (y > HEIGHT - RADIUS)
+        {
+            y  = HEIGHT - RADIUS;
+            vy = -std::fabs(vy);
+        }
+
+        canvas.coords(ball, std::vector<int>{
+            int(x) - RADIUS, int(y) - RADIUS,
+            int(x) + RADIUS, int(y) + RADIUS
+        });
+    });
+    animator.start();
+
+    // 1秒ごとにフレーム時間の統計を表示
+    auto reporter = tk::Timer::every(1000, [&]() {
+        auto stats = animator.stats();
+        char text[128];
+        std::snprintf(text, sizeof(text), "frames: %zu  dropped: %zu  avg: %.2f ms  p99: %.2f ms",
+                      stats.frames, stats.dropped_frames,
+                      stats.avg_frame_time.count() / 1e6, stats.p99_frame_time.count() / 1e6);
+        status.text(text);
+    });
+
+    auto toggle = tk::Button(app);
+    toggle
+        .text("Stop")
+        .command([&]() {
+            if (animator.running())
+            {
+                animator.stop();
+                toggle.text("Start");
+            }
+            else
+            {
+                animator.start();
+                toggle.text("Stop");
+            }
+        });
+    toggle.pack();
+
+    app.mainloop();
+
+    return 0;
+}
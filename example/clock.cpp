@@ -96,12 +96,13 @@ int main()
         canvas.coords(hour_hand_id, std::vector<int>{CENTER_X, CENTER_Y, hxy[0], hxy[1]});
         canvas.coords(minute_hand_id, std::vector<int>{CENTER_X, CENTER_Y, mxy[0], mxy[1]});
         canvas.coords(second_hand_id, std::vector<int>{CENTER_X, CENTER_Y, sxy[0], sxy[1]});
-
-        app.after(1000, update_clock); // 1秒ごとに更新
     };
 
     update_clock(); // 初回呼び出し
 
+    // 1秒ごとに更新(ハンドルが生きている間、同じタイマが周期的に呼ばれる)
+    auto ticker = tk::Timer::every(1000, update_clock);
+
     app.mainloop();
     return 0;
 }
\ No newline at end of file
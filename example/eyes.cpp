@@ -73,7 +73,7 @@ int main()
         {{"fill", "black"}, {"tags", "right_black"}}
     );
 
-    // マウス移動時のイベントを設定
+    // マウス移動時のイベントを設定(座標だけを置換させ、溜まった<Motion>は最新の1件だけを描画する)
     canvas.bind("<Motion>", [&](const tk::Event& event) {
 
         // 左の目の楕円のパラメータ算出
@@ -137,7 +137,7 @@ int main()
             {rx - BLACK_R, ry - BLACK_R,
             rx + BLACK_R, ry + BLACK_R}
         );
-    });
+    }, tk::EventField::X | tk::EventField::Y, tk::Coalesce::LATEST);
 
     app.mainloop();
 
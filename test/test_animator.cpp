@@ -0,0 +1,124 @@
+// Regression tests for tk::Animator (see docs/tasks.md section M): updates run once per frame at the
+// target rate, overrunning frames are skipped instead of queued, and frame-time statistics are kept.
+// The headless tests run on their own thread with a Tcl-only interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Animator: updates run every frame in registration order until stopped")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        tk::Animator animator(100.0);
+        CHECK(animator.fps() == doctest::Approx(100.0));
+        CHECK_FALSE(animator.running());
+
+        std::string order;
+        double first_dt = 0.0;
+        animator.add([&](double dt) { if (order.empty()) first_dt = dt; order += "a"; });
+        auto b = animator.add([&](double) { order += "b"; });
+        animator.start();
+        CHECK(animator.running());
+
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return order.size() >= 6; }));
+        CHECK(order.substr(0, 6) == "ababab");
+        CHECK(first_dt == doctest::Approx(0.01));
+
+        animator.remove(b);
+        order.clear();
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return order.size() >= 2; }));
+        CHECK(order.find('b') == std::string::npos);
+
+        animator.stop();
+        CHECK_FALSE(animator.running());
+        order.clear();
+        var.call({"after", 30});
+        var.call({"update"});
+        CHECK(order.empty());
+        CHECK(animator.stats().frames >= 5);
+    });
+}
+
+TEST_CASE("Animator: an overrunning frame skips the frames it missed and counts them")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        tk::Animator animator(100.0);
+        int frames = 0;
+        animator.add([&frames](double)
+        {
+            // The third frame takes about five periods.
+            if (++frames == 3)
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        });
+        animator.start();
+        REQUIRE(pump_until(var, std::chrono::milliseconds(3000), [&]() { return frames >= 6; }));
+        animator.stop();
+
+        auto stats = animator.stats();
+        CHECK(stats.frames == (std::size_t)frames);
+        CHECK(stats.dropped_frames >= 3);
+        CHECK(stats.max_frame_time >= std::chrono::milliseconds(50));
+        CHECK(stats.min_frame_time <= stats.avg_frame_time);
+        CHECK(stats.avg_frame_time <= stats.max_frame_time);
+        CHECK(stats.p99_frame_time <= stats.max_frame_time);
+
+        animator.reset_stats();
+        CHECK(animator.stats().frames == 0);
+        CHECK(animator.stats().dropped_frames == 0);
+    });
+}
+
+TEST_CASE("Animator: it may be stopped or destroyed from inside an update")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        int runs = 0;
+        tk::Animator stopping(200.0);
+        stopping.add([&](double) { if (++runs == 2) stopping.stop(); });
+        stopping.start();
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return !stopping.running(); }));
+        CHECK(runs == 2);
+
+        int after_destroy = 0;
+        std::unique_ptr<tk::Animator> owned(new tk::Animator(200.0));
+        owned->add([&](double) { owned.reset(); });
+        owned->add([&](double) { ++after_destroy; });
+        owned->start();
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return !owned; }));
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(after_destroy == 0);
+    });
+}
+
+TEST_CASE("Animator: canvas updates made in a frame are applied when the frame ends")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Canvas canvas(root);
+    auto id = canvas.create_rectangle(0, 0, 10, 10);
+
+    tk::Animator animator(100.0);
+    int frames = 0;
+    animator.add([&](double) { canvas.move(id, 1, 0); ++frames; });
+    animator.start();
+    REQUIRE(pump_until(root, std::chrono::milliseconds(2000), [&]() { return frames >= 5; }));
+    animator.stop();
+    CHECK(canvas.call_int_list({canvas.full_name(), "coords", id})[0] == frames);
+}
@@ -59,3 +59,179 @@ TEST_CASE("ArgValue: a DICT can be nested inside a LIST, and a LIST inside a DIC
     CHECK(style.call({"llength", nums}) == "3");
     CHECK(style.call({"lindex", nums, 1}) == "2");
 }
+
+// The tests below only exercise ArgValue's own storage (docs/tasks.md section M), so they need no
+// interpreter.
+TEST_CASE("ArgValue: moving steals the value and leaves the source as NONE")
+{
+    tk::ArgValue nested = tk::list({"a", tk::list({1, 2.5, true})});
+    tk::ArgValue moved(std::move(nested));
+
+    CHECK(nested.type() == tk::ArgValue::ValueType::NONE);
+    REQUIRE(moved.type() == tk::ArgValue::ValueType::LIST);
+    CHECK(moved.as_list()[1].as_list()[1].as_double() == 2.5);
+
+    tk::ArgValue text = std::string("a string long enough to live outside the inline buffer");
+    tk::ArgValue target = 1;
+    target = std::move(text);
+    CHECK(text.type() == tk::ArgValue::ValueType::NONE);
+    CHECK(target.as_string() == "a string long enough to live outside the inline buffer");
+}
+
+TEST_CASE("ArgValue: copies are deep and independent of the source")
+{
+    tk::ArgValue original = tk::dict({{"key", tk::list({"x", "y"})}});
+    tk::ArgValue copy = original;
+    original = std::vector<uint8_t>{1, 2, 3};
+
+    CHECK(original.as_bytes().size() == 3);
+    REQUIRE(copy.type() == tk::ArgValue::ValueType::DICT);
+    CHECK(copy.as_dict().at("key").as_list()[1].as_string() == "y");
+}
+
+TEST_CASE("ArgValue: assigning one of its own elements to a value is safe")
+{
+    tk::ArgValue value = tk::list({"outer", tk::list({"inner"})});
+    value = value.as_list()[1];
+
+    REQUIRE(value.type() == tk::ArgValue::ValueType::LIST);
+    CHECK(value.as_list()[0].as_string() == "inner");
+}
+
+TEST_CASE("ArgValue: a vector of values survives reallocation")
+{
+    std::vector<tk::ArgValue> words;
+    for (int i = 0; i < 100; ++i)
+    {
+        words.push_back("-option" + std::to_string(i));
+        words.push_back(tk::list({i, "v"}));
+    }
+    CHECK(words[0].as_string() == "-option0");
+    CHECK(words[199].as_list()[0].as_int() == 99);
+}
+
+TEST_CASE("TclValue: a prebuilt value can be passed to many calls and nested inside lists")
+{
+    tk::Tk root;
+    tk::ttk::Style style;
+
+    tk::TclValue points(tk::list({1, 2, 3, 4}));
+    CHECK_FALSE(points.empty());
+    CHECK(points.str() == "1 2 3 4");
+
+    for (int i = 0; i < 3; ++i)
+        CHECK(style.call({"llength", points}) == "4");
+    CHECK(style.call({"llength", tk::list({points, points})}) == "2");
+    CHECK(style.call({"lindex", tk::list({points}), 0, 2}) == "3");
+}
+
+TEST_CASE("TclValue: call_value() hands a result to the next command without going through std::string")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    auto range = root.call_value({"lrepeat", 3, "x"});
+    CHECK(range.str() == "x x x");
+    CHECK(root.call_int({"llength", range}) == 3);
+
+    bool ok = true;
+    auto failed = root.call_value({"no_such_command_for_call_value"}, &ok);
+    CHECK(ok == false);
+    CHECK(failed.empty());
+    CHECK(tk::ArgValue(failed).type() == tk::ArgValue::ValueType::NONE);
+}
+
+TEST_CASE("TclValue: Canvas coordinate APIs accept a prebuilt coordinate list")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root);
+    tk::TclValue line(tk::list({0, 0, 10, 10, 20, 0}));
+    auto id = canvas.create_line(line, {{"fill", "red"}});
+    CHECK(canvas.call_int({"llength", canvas.call_value({canvas.full_name(), "coords", id})}) == 6);
+
+    tk::TclValue moved(tk::list({5, 5, 15, 15}));
+    canvas.coords(id, moved);
+    auto coords = canvas.call_int_list({canvas.full_name(), "coords", id});
+    REQUIRE(coords.size() == 4);
+    CHECK(coords[0] == 5);
+
+    auto poly = canvas.create_polygon(tk::TclValue(tk::list({0, 0, 10, 0, 5, 5})));
+    CHECK(canvas.call({canvas.full_name(), "type", poly}) == "polygon");
+}
+
+TEST_CASE("StringRef: a borrowed buffer reaches Tcl unchanged, including when its length excludes a tail")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    std::string payload(100000, 'x');
+    payload += "tail";
+    CHECK(root.call_int({"string", "length", tk::StringRef(payload)}) == 100004);
+
+    const char buffer[] = "abcdef";
+    CHECK(root.call({"string", "range", tk::StringRef(buffer, 3), 0, "end"}) == "abc");
+
+    // Copying the ArgValue copies only the reference, not the referenced bytes.
+    tk::ArgValue ref = tk::StringRef(payload);
+    tk::ArgValue copy = ref;
+    CHECK(copy.type() == tk::ArgValue::ValueType::STRING_REF);
+    CHECK(copy.as_string_ref().data == payload.data());
+}
+
+TEST_CASE("StringRef: large-payload APIs accept borrowed buffers")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Text text(root);
+    std::string chunk = "line 1\nline 2\n";
+    text.insert(tk::END, tk::StringRef(chunk.data(), 7));
+    text.insert(tk::END, chunk);
+    CHECK(text.get("1.0", "end-1c") == "line 1\nline 1\nline 2\n");
+
+    tk::PhotoImage image({{"width", 2}, {"height", 1}});
+    std::string pixels = "{#ff0000 #00ff00}";
+    image.put(tk::StringRef(pixels));
+    CHECK(image.get(1, 0) == "0 255 0");
+}
+
+TEST_CASE("IntArrayRef/DoubleArrayRef: a numeric array becomes a single Tcl list word")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    std::vector<int> ints(200);
+    for (int i = 0; i < 200; ++i)
+        ints[i] = i;
+    CHECK(root.call_int({"llength", tk::IntArrayRef(ints)}) == 200);
+    CHECK(root.call_int({"lindex", tk::IntArrayRef(ints), 199}) == 199);
+
+    std::vector<double> doubles = {0.5, 1.25};
+    CHECK(root.call_double({"lindex", tk::DoubleArrayRef(doubles), 1}) == 1.25);
+    CHECK(root.call_int({"llength", tk::IntArrayRef(nullptr, 0)}) == 0);
+
+    tk::ArgValue ref = tk::IntArrayRef(ints);
+    tk::ArgValue copy = ref;
+    CHECK(copy.type() == tk::ArgValue::ValueType::INT_ARRAY);
+    CHECK(copy.as_int_array().data == ints.data());
+}
+
+TEST_CASE("IntArrayRef/DoubleArrayRef: Canvas coordinate APIs pass the coordinates as one list")
+{
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root);
+    auto line = canvas.create_line({{{0.0, 0.0}}, {{10.5, 10.0}}, {{20.0, 0.0}}}, {{"fill", "red"}});
+    auto coords = canvas.call_list({canvas.full_name(), "coords", line});
+    REQUIRE(coords.size() == 6);
+    CHECK(coords[2] == "10.5");
+
+    auto poly = canvas.create_polygon({0, 0, 10, 0, 5, 5});
+    CHECK(canvas.call_int_list({canvas.full_name(), "coords", poly}).size() == 6);
+
+    canvas.coords(poly, std::vector<int>{1, 1, 9, 1, 5, 4});
+    CHECK(canvas.call_int_list({canvas.full_name(), "coords", poly})[5] == 4);
+}
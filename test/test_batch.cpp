@@ -0,0 +1,137 @@
+// Regression tests for tk::Batch (see docs/tasks.md section M): setters issued inside a batch are
+// deferred and evaluated together, calls that need a result flush the queue first so call order is
+// preserved, and failing batched commands are still reported one by one under the ErrorPolicy.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Batch: widgets created and packed inside a batch exist after the scope ends")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    std::vector<tk::Label> labels;
+    {
+        tk::Batch batch;
+        for (int i = 0; i < 50; ++i)
+        {
+            labels.emplace_back(root, std::map<std::string, tk::ArgValue>{{"text", std::to_string(i)}});
+            labels.back().pack();
+        }
+    }
+
+    CHECK(root.call({"info", "commands", labels.back().full_name()}) == labels.back().full_name());
+    CHECK(labels.back().cget("text") == "49");
+    CHECK(root.call_list({"pack", "slaves", "."}).size() == 50);
+}
+
+TEST_CASE("Batch: a call that needs a result flushes pending commands first")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root, {{"text", "old"}});
+    tk::Batch batch;
+    label.config({{"text", "new"}});
+    CHECK(label.cget("text") == "new");
+}
+
+TEST_CASE("Batch: nested batches only flush at the outermost scope")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root);
+    auto id = canvas.create_rectangle(0, 0, 10, 10);
+    {
+        tk::Batch outer;
+        {
+            tk::Batch inner;
+            canvas.move(id, 5, 5);
+        }
+        canvas.move(id, 5, 5);
+    }
+    auto coords = canvas.call_int_list({canvas.full_name(), "coords", id});
+    REQUIRE(coords.size() == 4);
+    CHECK(coords[0] == 10);
+    CHECK(coords[1] == 10);
+}
+
+TEST_CASE("Batch: flush() reports a failing command as an Error under the DEFAULT policy")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root, {{"text", "old"}});
+    tk::Batch batch;
+    label.config({{"not_an_option", 1}});
+    label.config({{"text", "new"}});
+    CHECK_THROWS_AS(batch.flush(), tk::Error);
+
+    // Commands behind the first failure are discarded, as if the exception had stopped the caller.
+    CHECK_NOTHROW(batch.flush());
+    CHECK(label.cget("text") == "old");
+}
+
+TEST_CASE("Batch: failures are logged one by one and do not stop later commands with a success flag")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root, {{"text", "old"}});
+    tk::Batch batch;
+    label.config({{"not_an_option", 1}});
+    label.config({{"text", "new"}});
+
+    bool ok = true;
+    batch.flush(&ok);
+    CHECK(ok == false);
+    CHECK(label.cget("text") == "new");
+}
+
+TEST_CASE("Batch: a failing queued setter is reported as a batch failure and the getter still runs")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(0));
+    tk::Tk root;
+    root.withdraw();
+    tk::drain_errors();
+
+    tk::Label label(root, {{"text", "old"}});
+    tk::Batch batch;
+    label.config({{"not_an_option", 1}});
+    label.config({{"text", "new"}});
+
+    std::string text;
+    CHECK_NOTHROW(text = label.cget("text"));
+    CHECK(text == "new");
+
+    auto errors = tk::drain_errors();
+    REQUIRE(errors.size() == 1);
+    CHECK(errors[0].what() == "batch() failed to execute Tcl command");
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+}
+
+TEST_CASE("Batch: destroy takes effect immediately instead of being queued")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label doomed(root);
+    bool destroyed = false;
+    doomed.bind("<Destroy>", [&](const tk::Event&) { destroyed = true; });
+
+    tk::Batch batch;
+    doomed.config({{"text", "queued"}});
+    doomed.destroy();
+    // Checked without another Tcl call, which would flush the queue anyway.
+    CHECK(destroyed);
+}
@@ -0,0 +1,228 @@
+// Regression tests for the allocation/lookup fast paths of call() (see docs/tasks.md section M).
+// These paths only change how Tcl_Obj words are built and reused, so every test here checks that
+// the observable result is exactly the same as with freshly built words.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Cached widget path: repeated configure/cget on the same widget keep working")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root, {{"text", "first"}});
+    for (int i = 0; i < 100; ++i)
+        label.config({{"text", std::to_string(i)}});
+
+    CHECK(label.cget("text") == "99");
+}
+
+TEST_CASE("Cached widget path: a word equal to the path is still passed as plain data")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root);
+    label.config({{"text", label.full_name()}});
+    CHECK(label.cget("text") == label.full_name());
+}
+
+TEST_CASE("Interned words: subcommand names are still passed as plain data")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root);
+    label.config({{"text", "configure"}});
+    CHECK(label.cget("text") == "configure");
+    CHECK(root.call({"string", "length", "-textvariable"}) == "13");
+}
+
+TEST_CASE("Cached widget path: a widget recreated under the same name resolves to the new command")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Frame frame(root);
+    auto path = frame.full_name();
+    frame.destroy();
+
+    root.call({"label", path, "-text", "recreated"});
+    auto same = root.nametowidget(path);
+    CHECK(same.cget("text") == "recreated");
+    same.config({{"text", "again"}});
+    CHECK(same.cget("text") == "again");
+}
+
+TEST_CASE("Typed results: call_int/call_double/call_bool/call_list read the result object directly")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    CHECK(root.call_int({"expr", "{6 * 7}"}) == 42);
+    CHECK(root.call_double({"expr", "{1.5 * 2}"}) == doctest::Approx(3.0));
+    CHECK(root.call_bool({"string", "is", "integer", "12"}) == true);
+    CHECK(root.call_bool({"set", "tmp", "yes"}) == true);
+
+    auto items = root.call_list({"list", "a b", "c", ""});
+    REQUIRE(items.size() == 3);
+    CHECK(items[0] == "a b");
+    CHECK(items[1] == "c");
+    CHECK(items[2] == "");
+
+    auto ints = root.call_int_list({"list", 1, "2", "x"});
+    REQUIRE(ints.size() == 3);
+    CHECK(ints[0] == 1);
+    CHECK(ints[1] == 2);
+    CHECK(ints[2] == 0);
+}
+
+TEST_CASE("Typed results: uninterpretable results fall back to 0, and failures follow success/ErrorPolicy")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    CHECK(root.call_int({"set", "tmp", "??"}) == 0);
+    CHECK(root.call_double({"set", "tmp", ""}) == 0.0);
+    CHECK(root.call_list({"set", "tmp", "{unbalanced"}).empty());
+
+    bool ok = true;
+    CHECK(root.call_int({"no_such_command_for_typed_results"}, &ok) == 0);
+    CHECK(ok == false);
+    CHECK_THROWS_AS(root.call_int({"no_such_command_for_typed_results"}), tk::Error);
+}
+
+TEST_CASE("Typed results: getters moved onto the typed accessors keep their values")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root, {{"width", 200}, {"height", 100}});
+    auto id = canvas.create_rectangle(10, 20, 30, 40);
+    auto box = canvas.bbox(id);
+    REQUIRE(box.size() == 4);
+    CHECK(box[0] <= 10);
+    CHECK(box[3] >= 40);
+    CHECK(canvas.bbox("no_such_tag").empty());
+
+    tk::Listbox listbox(root);
+    listbox.insert(tk::END, "a");
+    listbox.insert(tk::END, "b");
+    listbox.select_set("1");
+    auto selected = listbox.curselection();
+    REQUIRE(selected.size() == 1);
+    CHECK(selected[0] == 1);
+
+    CHECK(root.winfo_exists() == true);
+}
+
+TEST_CASE("Direct dispatch: hot Canvas/Text calls give the same results as going through Tcl_EvalObjv")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root);
+    auto id = canvas.create_rectangle(0, 0, 10, 10);
+    for (int i = 0; i < 10; ++i)
+        canvas.move(id, 1, 2);
+    auto coords = canvas.call_int_list({canvas.full_name(), "coords", id});
+    REQUIRE(coords.size() == 4);
+    CHECK(coords[0] == 10);
+    CHECK(coords[1] == 20);
+
+    canvas.coords(id, std::vector<int>{1, 2, 3, 4});
+    coords = canvas.call_int_list({canvas.full_name(), "coords", id});
+    REQUIRE(coords.size() == 4);
+    CHECK(coords[3] == 4);
+
+    tk::Text text(root);
+    text.insert(tk::END, "hello");
+    text.insert(tk::END, " world");
+    CHECK(text.get("1.0", "end-1c") == "hello world");
+}
+
+TEST_CASE("Direct dispatch: the cached command is dropped when the widget command is deleted or renamed")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Canvas canvas(root);
+    auto path = canvas.full_name();
+    auto id = canvas.create_rectangle(0, 0, 10, 10);
+    canvas.move(id, 1, 1);
+
+    // Recreate a widget under the same path: the handle must talk to the new command.
+    canvas.destroy();
+    root.call({"canvas", path});
+    auto new_id = canvas.create_rectangle(0, 0, 10, 10);
+    canvas.move(new_id, 5, 5);
+    auto coords = canvas.call_int_list({path, "coords", new_id});
+    REQUIRE(coords.size() == 4);
+    CHECK(coords[0] == 5);
+
+    // After a rename the old path no longer names a command, so the call must fail instead of
+    // silently reaching the renamed command.
+    root.call({"rename", path, path + "_renamed"});
+    CHECK_THROWS_AS(canvas.move(new_id, 1, 1), tk::Error);
+    root.call({"rename", path + "_renamed", path});
+    CHECK_NOTHROW(canvas.move(new_id, 1, 1));
+}
+
+TEST_CASE("Direct dispatch: cached objects released off the owner thread, or after it exited, are safe")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    // The last handle is dropped on another thread: the cleanup runs on the owner thread.
+    std::unique_ptr<tk::Canvas> shared(new tk::Canvas(root));
+    auto id = shared->create_rectangle(0, 0, 10, 10);
+    shared->move(id, 1, 1);
+    run_on_fresh_thread([&]() { shared.reset(); });
+    CHECK_NOTHROW(root.update());
+
+    // The owner thread exits first: the handle is released without touching Tcl.
+    std::unique_ptr<tk::Canvas> escaped;
+    run_on_fresh_thread([&]() {
+        tk::Tk worker_root;
+        worker_root.withdraw();
+        escaped.reset(new tk::Canvas(worker_root));
+        auto item = escaped->create_rectangle(0, 0, 10, 10);
+        escaped->move(item, 1, 1);
+    });
+    CHECK_NOTHROW(escaped.reset());
+}
+
+TEST_CASE("Result-free setters: still report failures and keep their effects in call order")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Text text(root);
+    text.insert(tk::END, "abcdef");
+    text.erase("1.0", "1.3");
+    text.tag_add("hot", "1.0", "1.2");
+    CHECK(text.get("1.0", "end-1c") == "def");
+    CHECK(text.call_list({text.full_name(), "tag", "ranges", "hot"}).size() == 2);
+
+    root.title("setter title");
+    CHECK(root.call({"wm", "title", "."}) == "setter title");
+
+    // A failing setter must still be reported, even though its (error) result is never read.
+    CHECK_THROWS_AS(text.tag_add("hot", "not-an-index", "end"), tk::Error);
+}
@@ -0,0 +1,214 @@
+// Regression tests for opt-in callback profiling (tk::set_callback_profiling()/tk::callback_stats(), see
+// docs/tasks.md section M): calls, total/max time and the latency histogram are recorded per callback
+// only while profiling is enabled, and the periodic dump runs on the event loop.
+// The variable-trace tests run headless on their own thread with a Tcl-only interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+namespace tk = cpp_tk;
+
+namespace
+{
+
+const tk::CallbackStats* find_stats(const std::vector<tk::CallbackStats>& stats, const std::string& name)
+{
+    for (const auto& entry : stats)
+    {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+// Turns profiling off again even when a check fails, so other test cases start from the default.
+struct ProfilingScope
+{
+    ProfilingScope()  { tk::set_callback_profiling(true); }
+    ~ProfilingScope() { tk::set_callback_profiling(false); }
+};
+
+} // namespace
+
+TEST_CASE("Callback profiling: nothing is recorded while profiling is disabled")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::IntVar var;
+        var.trace([](const int&) {});
+        for (int i = 0; i < 10; ++i)
+            var.set(i);
+        CHECK(tk::callback_stats().empty());
+    });
+}
+
+TEST_CASE("Callback profiling: variable traces record calls, times and a histogram")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        ProfilingScope profiling;
+
+        tk::IntVar fast;
+        fast.trace([](const int&) {});
+        tk::IntVar slow;
+        slow.trace([](const int&) { std::this_thread::sleep_for(std::chrono::milliseconds(3)); });
+
+        for (int i = 0; i < 20; ++i)
+            fast.set(i);
+        slow.set(1);
+        slow.set(2);
+
+        // Each trace has its own entry, described by the variable name; the slowest one comes first.
+        auto stats = tk::callback_stats();
+        REQUIRE(stats.size() == 2);
+        const auto& slow_stats = stats[0];
+        const auto& fast_stats = stats[1];
+        CHECK(slow_stats.name.compare(0, 6, "trace ") == 0);
+        CHECK(slow_stats.description == slow.name());
+        CHECK(fast_stats.description == fast.name());
+        CHECK(slow_stats.name != fast_stats.name);
+        CHECK(fast_stats.calls == 20);
+        CHECK(slow_stats.calls == 2);
+        CHECK(std::accumulate(fast_stats.histogram.begin(), fast_stats.histogram.end(), std::size_t(0)) == 20);
+        CHECK(slow_stats.max_time <= slow_stats.total_time);
+        CHECK(slow_stats.max_time >= std::chrono::milliseconds(3));
+        CHECK(slow_stats.total_time >= std::chrono::milliseconds(6));
+        // The two 3ms calls fall into the "2ms to 4ms" bucket or a later one.
+        CHECK(std::accumulate(slow_stats.histogram.begin() + 4, slow_stats.histogram.end(), std::size_t(0)) == 2);
+
+        tk::reset_callback_stats();
+        CHECK(tk::callback_stats().empty());
+    });
+}
+
+TEST_CASE("Callback profiling: creating and destroying traced variables keeps the table bounded")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        ProfilingScope profiling;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            tk::IntVar var;
+            var.trace([](const int&) {});
+            var.set(i);
+        }
+
+        // Each destroyed variable releases its trace, which folds its entry into "trace".
+        auto stats = tk::callback_stats();
+        REQUIRE(stats.size() == 1);
+        CHECK(stats[0].name == "trace");
+        CHECK(stats[0].calls == 200);
+
+        // Tracing a live variable again folds the replaced trace as well.
+        tk::IntVar var;
+        var.trace([](const int&) {});
+        var.set(1);
+        var.trace([](const int&) {});
+        var.set(2);
+        stats = tk::callback_stats();
+        REQUIRE(stats.size() == 2);
+        const auto* folded = find_stats(stats, "trace");
+        REQUIRE(folded != nullptr);
+        CHECK(folded->calls == 201);
+        tk::reset_callback_stats();
+    });
+}
+
+TEST_CASE("Callback profiling: the periodic dump hands the stats to the sink from the event loop")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        ProfilingScope profiling;
+
+        tk::StringVar var;
+        var.trace([](const std::string&) {});
+        var.set("a");
+
+        int dumps = 0;
+        std::size_t seen_calls = 0;
+        tk::set_callback_stats_dump(std::chrono::milliseconds(5), [&](const std::vector<tk::CallbackStats>& stats)
+        {
+            ++dumps;
+            for (const auto& entry : stats)
+            {
+                if (entry.description == var.name())
+                    seen_calls = entry.calls;
+            }
+        });
+
+        var.call({"after", 30});
+        var.call({"update"});
+        CHECK(dumps >= 1);
+        CHECK(seen_calls == 1);
+
+        tk::set_callback_stats_dump(std::chrono::milliseconds(0));
+        const int stopped_at = dumps;
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(dumps == stopped_at);
+    });
+}
+
+TEST_CASE("Callback profiling: widget callbacks are described by their widget and role")
+{
+    tk::Tk root;
+    root.withdraw();
+    ProfilingScope profiling;
+    tk::reset_callback_stats();
+
+    tk::Button button(root);
+    button.command([]() {});
+    button.invoke();
+    button.invoke();
+
+    auto stats = tk::callback_stats();
+    REQUIRE(stats.size() == 1);
+    CHECK(stats[0].name.compare(0, 9, "cpp_tk_cb") == 0);
+    CHECK(stats[0].description == button.full_name() + " command");
+    CHECK(stats[0].calls == 2);
+}
+
+TEST_CASE("Callback profiling: timers are recorded per timer and folded into one entry once released")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        ProfilingScope profiling;
+        tk::reset_callback_stats();
+
+        tk::StringVar var;
+        int ticks = 0;
+        tk::Timer periodic = tk::Timer::every(5, [&]() { ++ticks; });
+        for (int i = 0; i < 20; ++i)
+            tk::Timer::once(1, []() {}).detach();
+        var.call({"after", 30});
+        var.call({"update"});
+        REQUIRE(ticks >= 1);
+
+        // The one-shot timers have all been released; only the live periodic timer keeps its own entry.
+        auto stats = tk::callback_stats();
+        REQUIRE(stats.size() == 2);
+        const auto* released = find_stats(stats, "timer");
+        REQUIRE(released != nullptr);
+        CHECK(released->calls == 20);
+        const tk::CallbackStats* live = stats[0].name == "timer" ? &stats[1] : &stats[0];
+        CHECK(live->name.compare(0, 6, "timer ") == 0);
+        CHECK(live->calls == (std::size_t)ticks);
+
+        periodic.cancel();
+        stats = tk::callback_stats();
+        REQUIRE(stats.size() == 1);
+        CHECK(stats[0].name == "timer");
+        CHECK(stats[0].calls == 20 + (std::size_t)ticks);
+    });
+}
@@ -0,0 +1,264 @@
+// Regression tests for callback reclamation and tk::stats() (see docs/tasks.md section M):
+// after() callbacks are deleted once they fire or are cancelled, widget callbacks are deleted with
+// their widget or on unbind, and the number of live callbacks stays flat in a long-running loop.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+
+namespace tk = cpp_tk;
+
+namespace
+{
+
+std::size_t live_callbacks()
+{
+    return tk::stats().live_callbacks;
+}
+
+} // namespace
+
+TEST_CASE("stats: variable traces are counted and released when the variable goes away")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        const auto before = live_callbacks();
+
+        tk::StringVar var;
+        var.trace([](const std::string&) {});
+        CHECK(live_callbacks() == before + 1);
+
+        // Tracing again replaces the callback instead of adding one.
+        var.trace([](const std::string&) {});
+        CHECK(live_callbacks() == before + 1);
+
+        var.call({"unset", var.name()});
+        CHECK(live_callbacks() == before);
+
+        auto s = tk::stats();
+        CHECK(s.callbacks_created - s.callbacks_released == s.live_callbacks);
+    });
+}
+
+TEST_CASE("stats: destroying the last copy of a traced variable releases its trace")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        const auto before = live_callbacks();
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            tk::IntVar var;
+            var.trace([](const int&) {});
+            var.set(i);
+        }
+        CHECK(live_callbacks() == before);
+
+        int calls = 0;
+        std::string name;
+        {
+            tk::IntVar copy;
+            {
+                tk::IntVar var;
+                name = var.name();
+                var.trace([&calls](const int&) { ++calls; });
+                copy = var;
+            }
+            // A remaining copy keeps the trace.
+            CHECK(live_callbacks() == before + 1);
+            copy.set(1);
+            CHECK(calls == 1);
+        }
+        CHECK(live_callbacks() == before);
+
+        tk::StringVar other;
+        other.call({"set", name, "2"});
+        CHECK(calls == 1);
+    });
+}
+
+TEST_CASE("stats: resetting the interpreter releases every callback it held")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        const auto before = live_callbacks();
+
+        std::vector<tk::IntVar> vars(20);
+        for (auto& var : vars)
+            var.trace([](const int&) {});
+        CHECK(live_callbacks() == before + 20);
+
+        tk::reset_interpreter();
+        CHECK(live_callbacks() == before);
+    });
+}
+
+TEST_CASE("Reclamation: after() callbacks are released once they fire, in a long-running loop")
+{
+    tk::Tk root;
+    root.withdraw();
+    root.update();
+    const auto before = live_callbacks();
+
+    // A compressed soak test: a self-rescheduling after() chain that runs many times.
+    const int rounds = 5000;
+    int fired = 0;
+    std::function<void()> tick;
+    tick = [&]()
+    {
+        if (++fired < rounds)
+            root.after(0, tick);
+        else
+            root.quit();
+    };
+    root.after(0, tick);
+    root.mainloop();
+
+    CHECK(fired == rounds);
+    CHECK(live_callbacks() == before);
+}
+
+TEST_CASE("Reclamation: after_cancel() and after_idle() release their callbacks")
+{
+    tk::Tk root;
+    root.withdraw();
+    root.update();
+    const auto before = live_callbacks();
+
+    auto id = root.after(60000, []() {});
+    CHECK(live_callbacks() == before + 1);
+    root.after_cancel(id);
+    CHECK(live_callbacks() == before);
+
+    // Cancelling an unknown or already cancelled id is still harmless.
+    CHECK_NOTHROW(root.after_cancel(id));
+    CHECK_NOTHROW(root.after_cancel("after#no_such_id"));
+
+    // Cancelling many pending ids releases each callback, and a fired id is forgotten.
+    int fired = 0;
+    std::vector<std::string> ids;
+    for (int i = 0; i < 2000; ++i)
+        ids.push_back(root.after(60000, [&fired]() { ++fired; }));
+    auto soon = root.after(0, [&fired]() { ++fired; });
+    CHECK(live_callbacks() == before + 2001);
+    root.update();
+    CHECK(fired == 1);
+    CHECK_NOTHROW(root.after_cancel(soon));
+    for (const auto& pending : ids)
+        root.after_cancel(pending);
+    CHECK(live_callbacks() == before);
+    root.update();
+    CHECK(fired == 1);
+
+    int idle_runs = 0;
+    root.after_idle([&idle_runs]() { ++idle_runs; });
+    root.after_idle([&idle_runs]() { idle_runs += 10; });
+    root.update_idletasks();
+    CHECK(idle_runs == 11);
+    CHECK(live_callbacks() == before);
+}
+
+TEST_CASE("Reclamation: widget callbacks are released on unbind and when the widget is destroyed")
+{
+    tk::Tk root;
+    root.withdraw();
+    const auto before = live_callbacks();
+
+    auto token = std::make_shared<int>(0);
+    std::weak_ptr<int> watch = token;
+    {
+        tk::Button button(root);
+        button.command([token]() { ++*token; });
+        button.bind("<Enter>", [](const tk::Event&) {});
+        button.bind("<Leave>", [](const tk::Event&) {});
+        CHECK(live_callbacks() == before + 3);
+        CHECK(tk::stats().callback_owners >= 1);
+
+        button.unbind("<Leave>");
+        CHECK(live_callbacks() == before + 2);
+
+        // Rebinding the same event replaces the callback.
+        button.bind("<Enter>", [](const tk::Event&) {});
+        CHECK(live_callbacks() == before + 2);
+
+        token.reset();
+        CHECK_FALSE(watch.expired());
+        button.destroy();
+    }
+    CHECK(watch.expired());
+    CHECK(live_callbacks() == before);
+}
+
+TEST_CASE("Reclamation: unbind_all() and unbind_class() release their callbacks")
+{
+    tk::Tk root;
+    root.withdraw();
+    const auto before = live_callbacks();
+
+    tk::Button button(root);
+    button.bind_all("<F5>", [](const tk::Event&) {});
+    button.bind_class("Button", "<F6>", [](const tk::Event&) {});
+    button.bind_class("Label", "<F6>", [](const tk::Event&) {});
+    CHECK(live_callbacks() == before + 3);
+
+    button.unbind_all("<F5>");
+    CHECK(live_callbacks() == before + 2);
+    CHECK(root.call({"bind", "all", "<F5>"}).empty());
+
+    button.unbind_class("Button", "<F6>");
+    CHECK(live_callbacks() == before + 1);
+    CHECK(root.call({"bind", "Button", "<F6>"}).empty());
+
+    // Only the binding for the named class goes away.
+    CHECK_FALSE(root.call({"bind", "Label", "<F6>"}).empty());
+    button.unbind_class("Label", "<F6>");
+    CHECK(live_callbacks() == before);
+}
+
+TEST_CASE("Reclamation: menu entry callbacks are released with the entry or the menu")
+{
+    tk::Tk root;
+    root.withdraw();
+    const auto before = live_callbacks();
+
+    tk::Menu menu(root);
+    menu.add_command({{"label", "one"}}, []() {});
+    menu.add_separator();
+    menu.add_command({{"label", "two"}}, []() {});
+    CHECK(live_callbacks() == before + 2);
+
+    menu.erase("1");
+    CHECK(live_callbacks() == before + 2);
+    menu.erase("0");
+    CHECK(live_callbacks() == before + 1);
+
+    menu.destroy();
+    CHECK(live_callbacks() == before);
+}
+
+TEST_CASE("Reclamation: widgets created inside a batch still release their callbacks")
+{
+    tk::Tk root;
+    root.withdraw();
+    const auto before = live_callbacks();
+
+    std::vector<tk::Button> buttons;
+    {
+        tk::Batch batch;
+        for (int i = 0; i < 10; ++i)
+        {
+            buttons.emplace_back(root);
+            buttons.back().command([]() {});
+        }
+    }
+    CHECK(live_callbacks() == before + 10);
+
+    for (auto& button : buttons)
+        button.destroy();
+    CHECK(live_callbacks() == before);
+}
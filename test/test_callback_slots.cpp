@@ -0,0 +1,178 @@
+// Regression tests for callback dispatch through per-callback ClientData slots (see docs/tasks.md
+// section M): re-registering replaces the previous callback, a callback may replace itself while it
+// runs, slots are released with their Tcl command or variable trace, callback commands are named by
+// integer tokens, and bind() field masks limit the substitutions.
+// The variable-trace tests run headless on their own thread with a Tcl-only interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Callback slots: tracing a variable again replaces the previous callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        int first = 0;
+        int second = 0;
+        tk::IntVar var;
+        var.trace([&first](const int&) { ++first; });
+        var.trace([&second](const int& v) { second = v; });
+        var.set(7);
+
+        CHECK(first == 0);
+        CHECK(second == 7);
+    });
+}
+
+TEST_CASE("Callback slots: unsetting a traced variable releases its callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        auto token = std::make_shared<int>(0);
+        std::weak_ptr<int> watch = token;
+        tk::StringVar var;
+        var.trace([token](const std::string&) { ++*token; });
+        token.reset();
+
+        var.set("a");
+        CHECK(*watch.lock() == 1);
+
+        var.call({"unset", var.name()});
+        CHECK(watch.expired());
+
+        var.set("b");
+        CHECK(var.get() == "b");
+    });
+}
+
+TEST_CASE("Callback slots: a trace callback may replace itself while it runs")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        tk::DoubleVar var;
+        double seen = 0.0;
+        int calls = 0;
+        var.trace([&](const double& v)
+        {
+            ++calls;
+            seen = v;
+            var.trace([&](const double& w) { seen = -w; });
+        });
+
+        var.set(1.5);
+        CHECK(calls == 1);
+        CHECK(seen == 1.5);
+
+        var.set(2.5);
+        CHECK(calls == 1);
+        CHECK(seen == -2.5);
+    });
+}
+
+TEST_CASE("Callback slots: bind callbacks read numeric event fields straight from the arguments")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    tk::Event seen;
+    frame.bind("<Motion>", [&seen](const tk::Event& e) { seen = e; });
+    auto command = bound_command(frame, "<Motion>");
+    REQUIRE_FALSE(command.empty());
+
+    root.call({command, 12, "-3", 100, 200, frame.full_name(), "a", 38, "a", "Motion", "??"});
+    CHECK(seen.x == 12);
+    CHECK(seen.y == -3);
+    CHECK(seen.x_root == 100);
+    CHECK(seen.y_root == 200);
+    CHECK(seen.widget == frame.full_name());
+    CHECK(seen.keycode == 38);
+    CHECK(seen.type == "Motion");
+    CHECK(seen.delta == 0);
+}
+
+TEST_CASE("Callback slots: rebinding an event from inside its own callback is safe")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    int first = 0;
+    int second = 0;
+    frame.bind("<<Rebind>>", [&](const tk::Event&)
+    {
+        ++first;
+        frame.bind("<<Rebind>>", [&second](const tk::Event&) { ++second; });
+    });
+
+    auto command = bound_command(frame, "<<Rebind>>");
+    REQUIRE_FALSE(command.empty());
+    for (int i = 0; i < 2; ++i)
+        root.call({bound_command(frame, "<<Rebind>>"), 0, 0, 0, 0, frame.full_name(), "??", 0, "", "35", 0});
+
+    CHECK(first == 1);
+    CHECK(second == 1);
+}
+
+TEST_CASE("Callback slots: commands are named by integer tokens and rebinding does not add commands")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    frame.bind("<Enter>", [](const tk::Event&) {});
+    auto first = bound_command(frame, "<Enter>");
+    REQUIRE(first.compare(0, 9, "cpp_tk_cb") == 0);
+    CHECK(first.find_first_not_of("0123456789", 9) == std::string::npos);
+
+    const auto commands = root.call_list({"info", "commands", "cpp_tk_cb*"}).size();
+    for (int i = 0; i < 50; ++i)
+        frame.bind("<Enter>", [](const tk::Event&) {});
+    CHECK(root.call_list({"info", "commands", "cpp_tk_cb*"}).size() == commands);
+
+    // Tokens are never reused, so the replaced command name stays dead.
+    CHECK(bound_command(frame, "<Enter>") != first);
+    CHECK(root.call({"info", "commands", first}) == "");
+}
+
+TEST_CASE("Callback slots: a field mask limits the substitutions and the fields read into Event")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    tk::Event seen;
+    seen.keysym = "untouched";
+    frame.bind("<Motion>", [&seen](const tk::Event& e) { seen = e; }, tk::EventField::POSITION);
+    auto script = frame.call_list({"bind", frame.full_name(), "<Motion>"});
+    REQUIRE(script.size() == 3);
+    CHECK(script[1] == "%x");
+    CHECK(script[2] == "%y");
+
+    root.call({script[0], 7, 9});
+    CHECK(seen.x == 7);
+    CHECK(seen.y == 9);
+    CHECK(seen.keysym == "");
+
+    frame.bind("<Key>", [&seen](const tk::Event& e) { seen = e; }, tk::EventField::KEYSYM);
+    root.call({bound_command(frame, "<Key>"), "Return"});
+    CHECK(seen.keysym == "Return");
+    CHECK(seen.x == 0);
+
+    // The default still substitutes every field, with %c and %t for the character and the type as before.
+    frame.bind("<Button-1>", [](const tk::Event&) {});
+    auto full = frame.call_list({"bind", frame.full_name(), "<Button-1>"});
+    REQUIRE(full.size() == 11);
+    CHECK(full[8] == "%c");
+    CHECK(full[9] == "%t");
+}
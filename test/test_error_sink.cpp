@@ -0,0 +1,175 @@
+// Regression tests for the error sink: set_error_handler(), set_error_rate_limit() and
+// drain_errors() (see docs/tasks.md section M). Errors from uninitialized objects are reported
+// without touching Tcl, so most of these tests need no interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Error sink: the handler receives each reported error and drain_errors() returns it once")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(0));
+    tk::drain_errors();
+
+    std::vector<std::string> seen;
+    tk::set_error_handler([&](const tk::ErrorRecord& record) { seen.push_back(record.message()); });
+
+    tk::Button uninit;
+    bool ok = true;
+    for (int i = 0; i < 3; ++i)
+        uninit.call({"info", "patchlevel"}, &ok);
+    CHECK(ok == false);
+    REQUIRE(seen.size() == 3);
+    CHECK(seen[0].find("uninitialized") != std::string::npos);
+
+    auto records = tk::drain_errors();
+    REQUIRE(records.size() == 3);
+    CHECK(records[0].category == tk::ErrorPolicy::LENIENT_CALL);
+    CHECK(records[0].thread == std::this_thread::get_id());
+    CHECK(records[0].suppressed == 0);
+    CHECK(tk::drain_errors().empty());
+
+    tk::set_error_handler(nullptr);
+}
+
+TEST_CASE("Error sink: a storm of identical errors is reported once per interval, with a suppressed count")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(100));
+    tk::drain_errors();
+
+    int handled = 0;
+    tk::set_error_handler([&](const tk::ErrorRecord&) { ++handled; });
+
+    tk::Label uninit;
+    bool ok = true;
+    for (int i = 0; i < 1000; ++i)
+        uninit.call({"info", "patchlevel"}, &ok);
+    CHECK(handled == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    uninit.call({"info", "patchlevel"}, &ok);
+    CHECK(handled == 2);
+
+    auto records = tk::drain_errors();
+    REQUIRE(records.size() == 2);
+    CHECK(records[1].suppressed == 999);
+    CHECK(records[1].message().find("999 similar errors suppressed") != std::string::npos);
+
+    tk::set_error_handler(nullptr);
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+}
+
+TEST_CASE("Error sink: records keep their parts and a full buffer drops the oldest records")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(0));
+    tk::set_error_handler([](const tk::ErrorRecord&) {});
+    tk::drain_errors();
+
+    tk::Label widget;
+    tk::Var var;
+    bool ok = true;
+    for (int i = 0; i < 300; ++i)
+        widget.call({"info", "patchlevel"}, &ok);
+    for (int i = 0; i < 10; ++i)
+        var.call({"info", "patchlevel"}, &ok);
+
+    auto records = tk::drain_errors();
+    REQUIRE(records.size() == 256);
+    CHECK(records.front().kind == tk::ErrorRecord::Kind::UNINITIALIZED);
+    CHECK(std::string(records.front().operation) == "call");
+    CHECK(std::string(records.front().object_type) == "Widget");
+    CHECK(records.front().command_words.empty());
+    CHECK(records.front().what() == "call() called on an uninitialized Widget (interp == nullptr).");
+    // The newest records survive the overflow.
+    CHECK(std::string(records.back().object_type) == "Var");
+    CHECK(std::string(records[records.size() - 10].object_type) == "Var");
+    CHECK(std::string(records[records.size() - 11].object_type) == "Widget");
+
+    tk::set_error_handler(nullptr);
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+}
+
+TEST_CASE("Error sink: rate limiting never swallows the exception required by the policy")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+    tk::set_error_handler([](const tk::ErrorRecord&) {});
+
+    tk::Entry uninit;
+    for (int i = 0; i < 3; ++i)
+        CHECK_THROWS_AS(uninit.call({"info", "patchlevel"}), tk::Error);
+
+    tk::set_error_handler(nullptr);
+    tk::drain_errors();
+}
+
+TEST_CASE("Error sink: failed Tcl commands carry the Tcl message and the command words")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(0));
+    tk::Tk root;
+    root.withdraw();
+    tk::drain_errors();
+
+    tk::set_error_handler([](const tk::ErrorRecord&) {});
+    tk::Canvas canvas(root);
+    bool ok = true;
+    canvas.call({canvas.full_name(), "no_such_subcommand", 7}, &ok);
+    CHECK(ok == false);
+
+    auto records = tk::drain_errors();
+    REQUIRE(records.size() == 1);
+    CHECK(records[0].what() == "call() failed to execute Tcl command");
+    CHECK(records[0].detail.find("no_such_subcommand") != std::string::npos);
+    CHECK(records[0].command() == canvas.full_name() + " no_such_subcommand 7");
+
+    tk::set_error_handler(nullptr);
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+}
+
+TEST_CASE("Error sink: many sites failing in turn are each limited on their own")
+{
+    run_on_fresh_thread([]()
+    {
+        tk::create_tcl_only_interpreter();
+        tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+        tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+        tk::drain_errors();
+
+        // As many sites as the table has sets, so some of them share a set whatever the hash, but far
+        // fewer than the table holds, so none of them pushes another out.
+        const int sites = 64;
+        std::vector<std::string> commands;
+        for (int i = 0; i < sites; ++i)
+            commands.push_back("cpp_tk_no_such_command_" + std::to_string(i));
+
+        int handled = 0;
+        tk::set_error_handler([&](const tk::ErrorRecord&) { ++handled; });
+        tk::StringVar client;
+        bool ok = true;
+        for (int round = 0; round < 20; ++round)
+        {
+            for (const auto& command : commands)
+                client.call({command}, &ok);
+        }
+        CHECK(ok == false);
+        CHECK(handled == sites);
+
+        auto records = tk::drain_errors();
+        REQUIRE(records.size() == (std::size_t)sites);
+        for (int i = 0; i < sites; ++i)
+            CHECK(records[i].command() == commands[i]);
+
+        tk::set_error_handler(nullptr);
+    });
+}
@@ -0,0 +1,135 @@
+// Regression tests for coalesced event delivery (tk::Coalesce::LATEST, see docs/tasks.md section M):
+// a burst of events reaches the handler once at the next idle time with the newest event and the
+// number of events folded into it, and unbinding drops an event that has not been delivered yet.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Coalescing: a burst of events is delivered once with the newest event")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    int calls = 0;
+    tk::Event seen;
+    frame.bind("<Motion>", [&](const tk::Event& e) { ++calls; seen = e; },
+               tk::EventField::POSITION, tk::Coalesce::LATEST);
+    auto command = bound_command(frame, "<Motion>");
+    REQUIRE_FALSE(command.empty());
+
+    for (int i = 0; i < 50; ++i)
+        root.call({command, i, 100 - i});
+    CHECK(calls == 0);
+
+    root.update_idletasks();
+    CHECK(calls == 1);
+    CHECK(seen.x == 49);
+    CHECK(seen.y == 51);
+    CHECK(seen.coalesced == 49);
+
+    // A single event after delivery folds nothing.
+    root.call({command, 1, 2});
+    root.update_idletasks();
+    CHECK(calls == 2);
+    CHECK(seen.coalesced == 0);
+}
+
+TEST_CASE("Coalescing: the default mode still calls the handler for every event")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    int calls = 0;
+    frame.bind("<Configure>", [&calls](const tk::Event& e) { ++calls; CHECK(e.coalesced == 0); },
+               tk::EventField::WIDGET);
+    auto command = bound_command(frame, "<Configure>");
+    for (int i = 0; i < 5; ++i)
+        root.call({command, frame.full_name()});
+    CHECK(calls == 5);
+}
+
+TEST_CASE("Coalescing: unbinding or rebinding drops the event that is still pending")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+    const auto live = tk::stats().live_callbacks;
+
+    int calls = 0;
+    frame.bind("<B1-Motion>", [&calls](const tk::Event&) { ++calls; },
+               tk::EventField::POSITION, tk::Coalesce::LATEST);
+    root.call({bound_command(frame, "<B1-Motion>"), 1, 1});
+    frame.unbind("<B1-Motion>");
+    root.update_idletasks();
+    CHECK(calls == 0);
+    CHECK(tk::stats().live_callbacks == live);
+
+    frame.bind("<MouseWheel>", [&calls](const tk::Event&) { calls += 1; },
+               tk::EventField::DELTA, tk::Coalesce::LATEST);
+    root.call({bound_command(frame, "<MouseWheel>"), 120});
+    frame.bind("<MouseWheel>", [&calls](const tk::Event&) { calls += 100; },
+               tk::EventField::DELTA, tk::Coalesce::LATEST);
+    root.update_idletasks();
+    CHECK(calls == 0);
+}
+
+TEST_CASE("Coalescing: schedule_idle() and cancel_idle() with the command name cannot touch the pending delivery")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    int calls = 0;
+    frame.bind("<Motion>", [&calls](const tk::Event&) { ++calls; },
+               tk::EventField::POSITION, tk::Coalesce::LATEST);
+    auto command = bound_command(frame, "<Motion>");
+
+    root.call({command, 1, 1});
+    CHECK(tk::cancel_idle(command) == false);
+    int replaced = 0;
+    CHECK(tk::schedule_idle(command, [&replaced]() { ++replaced; }) == true);
+    root.update_idletasks();
+    CHECK(calls == 1);
+    CHECK(replaced == 1);
+
+    // The next burst is scheduled again, so the handler was not left waiting for a delivery.
+    root.call({command, 2, 2});
+    tk::cancel_idle(command);
+    root.update_idletasks();
+    CHECK(calls == 2);
+}
+
+TEST_CASE("Coalescing: a profiled delivery is recorded once, under the callback's command")
+{
+    tk::Tk root;
+    root.withdraw();
+    tk::Frame frame(root);
+
+    int calls = 0;
+    frame.bind("<Motion>", [&calls](const tk::Event&) { ++calls; },
+               tk::EventField::POSITION, tk::Coalesce::LATEST);
+    auto command = bound_command(frame, "<Motion>");
+
+    tk::reset_callback_stats();
+    tk::set_callback_profiling(true);
+    for (int i = 0; i < 10; ++i)
+        root.call({command, i, i});
+    root.update_idletasks();
+    tk::set_callback_profiling(false);
+    CHECK(calls == 1);
+
+    std::size_t recorded = 0;
+    for (const auto& entry : tk::callback_stats())
+    {
+        CHECK(entry.name.compare(0, 5, "idle ") != 0);
+        if (entry.name == command)
+            recorded = entry.calls;
+    }
+    CHECK(recorded == 1);
+    tk::reset_callback_stats();
+}
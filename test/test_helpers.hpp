@@ -0,0 +1,49 @@
+// Helpers shared by the tests (see docs/tasks.md section M). Tests that need a thread without an
+// interpreter, need to pump the event loop, or need the command behind a binding include this instead
+// of copying them.
+#pragma once
+
+#include "cpp_tk.hpp"
+
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+
+// Runs fn on a new thread, which starts without an interpreter of its own. Exceptions thrown on the
+// worker are rethrown on the test thread so doctest can report them.
+template<typename Fn>
+void run_on_fresh_thread(Fn fn)
+{
+    std::exception_ptr error;
+    std::thread worker([&]()
+    {
+        try { fn(); }
+        catch (...) { error = std::current_exception(); }
+    });
+    worker.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Runs the event loop until done() holds or the deadline passes.
+template<typename Pred>
+bool pump_until(cpp_tk::InterpreterClient& client, std::chrono::milliseconds deadline, Pred done)
+{
+    auto until = std::chrono::steady_clock::now() + deadline;
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() > until)
+            return false;
+        client.call({"after", 1});
+        client.call({"update"});
+    }
+    return true;
+}
+
+// The Tcl command a binding runs is the first word of its bound script.
+inline std::string bound_command(cpp_tk::Widget& widget, const std::string& event)
+{
+    auto script = widget.call_list({"bind", widget.full_name(), event});
+    return script.empty() ? std::string() : script[0];
+}
@@ -0,0 +1,119 @@
+// Regression tests for the keyed idle queue (tk::schedule_idle()/tk::cancel_idle(), see docs/tasks.md
+// section M): repeated requests with the same key run once at the next idle time, in the order they
+// were first requested, pending requests are dropped by cancel_idle() and reset_interpreter(), and
+// profiled runs fold into one "idle" entry.
+// The tests run headless on their own thread with a Tcl-only interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <string>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Idle queue: requests with the same key collapse into one run of the latest callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        const auto live = tk::stats().live_callbacks;
+
+        std::string order;
+        CHECK(tk::schedule_idle("redraw", [&order]() { order += "r1"; }));
+        CHECK(tk::schedule_idle("layout", [&order]() { order += "L"; }));
+        for (int i = 2; i <= 100; ++i)
+            CHECK_FALSE(tk::schedule_idle("redraw", [&order, i]() { order += "r" + std::to_string(i); }));
+        CHECK(tk::stats().live_callbacks == live + 2);
+        CHECK(order.empty());
+
+        var.call({"update", "idletasks"});
+        CHECK(order == "r100L");
+        CHECK(tk::stats().live_callbacks == live);
+
+        // Once run, the key can be scheduled again.
+        CHECK(tk::schedule_idle("redraw", [&order]() { order += "!"; }));
+        var.call({"update", "idletasks"});
+        CHECK(order == "r100L!");
+    });
+}
+
+TEST_CASE("Idle queue: a callback may schedule its own key again while the queue drains")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        // The running key is already off the queue, so the request is queued anew rather than merged.
+        int runs = 0;
+        bool requeued = true;
+        std::function<void()> again = [&]()
+        {
+            if (++runs < 3)
+                requeued = requeued && tk::schedule_idle("again", again);
+        };
+        tk::schedule_idle("again", again);
+
+        // "update idletasks" keeps servicing idle handlers until none are left.
+        var.call({"update", "idletasks"});
+        CHECK(runs == 3);
+        CHECK(requeued);
+    });
+}
+
+TEST_CASE("Idle queue: cancel_idle() and reset_interpreter() drop pending requests")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        const auto live = tk::stats().live_callbacks;
+
+        std::string ran;
+        tk::schedule_idle("a", [&ran]() { ran += "a"; });
+        tk::schedule_idle("b", [&ran]() { ran += "b"; });
+        CHECK(tk::cancel_idle("a"));
+        CHECK_FALSE(tk::cancel_idle("a"));
+        CHECK_FALSE(tk::cancel_idle("unknown"));
+        var.call({"update", "idletasks"});
+        CHECK(ran == "b");
+
+        tk::schedule_idle("c", [&ran]() { ran += "c"; });
+        tk::reset_interpreter();
+        var.call({"update", "idletasks"});
+        CHECK(ran == "b");
+        CHECK(tk::stats().live_callbacks == live);
+
+        // The queue works again after the reset.
+        tk::schedule_idle("d", [&ran]() { ran += "d"; });
+        var.call({"update", "idletasks"});
+        CHECK(ran == "bd");
+    });
+}
+
+TEST_CASE("Idle queue: profiling per-object keys keeps the stats table bounded")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        tk::set_callback_profiling(true);
+
+        for (int round = 0; round < 3; ++round)
+        {
+            for (int i = 0; i < 100; ++i)
+                tk::schedule_idle("redraw-" + std::to_string(round * 100 + i), []() {});
+            var.call({"update", "idletasks"});
+        }
+        tk::set_callback_profiling(false);
+
+        // Every run folds into the one "idle" entry instead of leaving one entry per key.
+        auto stats = tk::callback_stats();
+        REQUIRE(stats.size() == 1);
+        CHECK(stats[0].name == "idle");
+        CHECK(stats[0].calls == 300);
+        tk::reset_callback_stats();
+    });
+}
@@ -0,0 +1,129 @@
+// Regression tests for tk::reset_interpreter() (see docs/tasks.md section M): the calling thread's
+// Tcl interpreter is torn down and rebuilt in place, dropping variables, callbacks and posted jobs,
+// while C++ objects created before the reset stay safe to use and destroy.
+// The headless tests run on their own thread with a Tcl-only interpreter (kept across the reset).
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+namespace tk = cpp_tk;
+
+TEST_CASE("reset_interpreter: global state does not survive a reset")
+{
+    run_on_fresh_thread([]()
+    {
+        tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        tk::StringVar var;
+        var.set("before");
+        var.call({"proc", "reset_probe", "", "return probe"});
+        CHECK(var.call({"reset_probe"}) == "probe");
+
+        tk::reset_interpreter();
+
+        CHECK(var.call_bool({"info", "exists", var.name()}) == false);
+        CHECK_THROWS_AS(var.call({"reset_probe"}), tk::Error);
+
+        // The old object keeps working against the new interpreter.
+        var.set("after");
+        CHECK(var.get() == "after");
+
+        // The mode is kept: Tk is still not loaded.
+        CHECK(tk::create_tcl_only_interpreter() == false);
+        CHECK(var.call({"info", "commands", "winfo"}) == "");
+    });
+}
+
+// Runs on the test thread itself: post() must not be tested on a thread that reuses the id of an
+// exited thread which owned an interpreter, since Tcl still holds that thread's event queue.
+TEST_CASE("reset_interpreter: callbacks and pending posted jobs are dropped")
+{
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        int traced = 0;
+        tk::IntVar var;
+        var.trace([&traced](const int&) { ++traced; });
+        var.set(1);
+        CHECK(traced == 1);
+
+        bool posted_ran = false;
+        var.post([&posted_ran]() { posted_ran = true; });
+
+        tk::reset_interpreter();
+        var.call({"update"});
+        CHECK(posted_ran == false);
+
+        var.set(2);
+        CHECK(traced == 1);
+        CHECK(var.get() == 2);
+
+        // Jobs posted after the reset are delivered as usual.
+        var.post([&posted_ran]() { posted_ran = true; });
+        var.call({"update"});
+        CHECK(posted_ran == true);
+    }
+}
+
+TEST_CASE("reset_interpreter: a compiled tk::Script keeps running after a reset")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        tk::Script count("incr ::reset_counter");
+        CHECK(count.run() == "1");
+        CHECK(count.run() == "2");
+
+        for (int i = 0; i < 5; ++i)
+        {
+            tk::reset_interpreter();
+            CHECK(count.run() == "1");
+        }
+    });
+}
+
+TEST_CASE("reset_interpreter: it refuses to run from inside a callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        bool refused = false;
+        tk::StringVar var;
+        var.trace([&refused](const std::string&)
+        {
+            try { tk::reset_interpreter(); }
+            catch (const tk::Error&) { refused = true; }
+        });
+        var.set("x");
+        CHECK(refused == true);
+        CHECK(var.get() == "x");
+    });
+}
+
+TEST_CASE("reset_interpreter: Tk can be initialized again and old widgets fail cleanly")
+{
+    run_on_fresh_thread([]()
+    {
+        tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+        tk::Tk root;
+        root.withdraw();
+        tk::Canvas canvas(root);
+        auto id = canvas.create_rectangle(0, 0, 10, 10);
+        canvas.move(id, 1, 1);
+
+        tk::reset_interpreter();
+
+        CHECK_THROWS_AS(canvas.move(id, 1, 1), tk::Error);
+
+        tk::Tk fresh;
+        fresh.withdraw();
+        tk::Canvas again(fresh);
+        auto new_id = again.create_rectangle(0, 0, 10, 10);
+        again.move(new_id, 5, 5);
+        CHECK(again.call_int_list({again.full_name(), "coords", new_id})[0] == 5);
+    });
+}
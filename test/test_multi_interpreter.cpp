@@ -0,0 +1,176 @@
+// Stress test for running one independent Tk interpreter per thread (see docs/tasks.md
+// section M). Each thread builds its own tk::Tk, churns widgets from after() callbacks inside its
+// own mainloop, and quits. Process-wide state (object ids, menu callback names, error policy and
+// handlers, interpreter registry) is touched from every thread at once. Build with
+// -DCPP_TK_ENABLE_TSAN=ON to have ThreadSanitizer check it.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace tk = cpp_tk;
+
+static std::set<std::thread::id> registered_threads()
+{
+    auto threads = tk::interpreter_threads();
+    return std::set<std::thread::id>(threads.begin(), threads.end());
+}
+
+// Needs no interpreter: uninitialized objects report errors without touching Tcl.
+TEST_CASE("Multi-thread: error policy, handlers and error reporting can be used from many threads at once")
+{
+    tk::set_error_rate_limit(std::chrono::milliseconds(0));
+    std::atomic<int> handled{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 200; ++i)
+            {
+                if (t == 0)
+                    tk::set_error_handler([&](const tk::ErrorRecord&) { ++handled; });
+                if (t == 1)
+                    tk::set_error_policy(i % 2 ? tk::ErrorPolicy::LENIENT_CALL : tk::ErrorPolicy::DEFAULT);
+                tk::Label uninit;
+                bool ok = true;
+                uninit.call({"info", "patchlevel"}, &ok);
+                tk::error_policy();
+                tk::drain_errors();
+            }
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+
+    CHECK(handled.load() > 0);
+    tk::set_error_handler(nullptr);
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::set_error_rate_limit(std::chrono::milliseconds(1000));
+    tk::drain_errors();
+}
+
+TEST_CASE("Multi-thread: independent Tk interpreters run their own mainloop with widget churn")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    const int thread_count = 4;
+    const int rounds = 20;
+
+    std::mutex ids_mutex;
+    std::set<std::string> var_names;
+    std::set<std::thread::id> worker_ids;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int> finished{0};
+    std::atomic<int> failures{0};
+    const auto before = registered_threads();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&]() {
+            try
+            {
+                tk::Tk root;
+                root.withdraw();
+                {
+                    std::lock_guard<std::mutex> lock(ids_mutex);
+                    worker_ids.insert(std::this_thread::get_id());
+                }
+                ++ready;
+                while (!go.load())
+                    std::this_thread::yield();
+
+                int round = 0;
+                std::function<void()> churn = [&]() {
+                    tk::Frame frame(root);
+                    for (int i = 0; i < 10; ++i)
+                    {
+                        tk::StringVar var;
+                        var.set("value " + std::to_string(i));
+                        tk::Label(frame, tk::opts().textvariable(var)).pack();
+                        std::lock_guard<std::mutex> lock(ids_mutex);
+                        var_names.insert(var.name());
+                    }
+                    tk::Menu menu(root);
+                    menu.add_command({{"label", "item"}}, []() {});
+                    frame.destroy();
+
+                    if (++round < rounds)
+                        root.after(1, churn);
+                    else
+                        root.quit();
+                };
+                root.after(1, churn);
+                root.mainloop();
+                ++finished;
+            }
+            catch (const tk::Error&)
+            {
+                ++failures;
+                ++ready;
+            }
+        });
+    }
+
+    // Every worker is registered while it is alive, and no other thread shows up.
+    while (ready.load() < thread_count)
+        std::this_thread::yield();
+    auto expected = before;
+    expected.insert(worker_ids.begin(), worker_ids.end());
+    CHECK(worker_ids.size() == (size_t)thread_count);
+    CHECK(registered_threads() == expected);
+    go = true;
+
+    for (auto& th : threads)
+        th.join();
+
+    CHECK(failures.load() == 0);
+    CHECK(finished.load() == thread_count);
+    // Variable names are derived from process-wide object ids, so they must never collide.
+    CHECK(var_names.size() == (size_t)(thread_count * rounds * 10));
+    // Exited threads are unregistered (and their interpreters destroyed).
+    CHECK(registered_threads() == before);
+}
+
+TEST_CASE("Multi-thread: an exited thread leaves the registry and its objects stop touching Tcl")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    const auto before = registered_threads();
+
+    std::thread::id worker_id;
+    std::set<std::thread::id> while_alive;
+    std::unique_ptr<tk::StringVar> escaped;
+    run_on_fresh_thread([&]() {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        worker_id = std::this_thread::get_id();
+        while_alive = registered_threads();
+        escaped.reset(new tk::StringVar());
+        escaped->set("kept by another thread");
+    });
+
+    auto expected = before;
+    expected.insert(worker_id);
+    CHECK(while_alive == expected);
+    CHECK(registered_threads() == before);
+
+    // The Var outlives its interpreter: calls fail without touching Tcl, and posted jobs are dropped.
+    CHECK_THROWS_AS(escaped->set("too late"), tk::Error);
+    auto token = std::make_shared<int>(0);
+    CHECK_THROWS_AS(escaped->post([token]() { ++*token; }), tk::Error);
+    CHECK(token.use_count() == 1);
+    CHECK(*token == 0);
+
+    tk::set_error_policy(tk::ErrorPolicy::LENIENT_THREAD);
+    CHECK(escaped->get() == "");
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::drain_errors();
+}
@@ -0,0 +1,63 @@
+// Regression tests for tk::Options / tk::opts(), the flat option list accepted by every
+// options-taking API (see docs/tasks.md section M). Map literals must keep their old meaning,
+// and the builder must produce the same words without going through std::map.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+
+namespace tk = cpp_tk;
+
+// The tests below only inspect the words an Options holds, so they need no interpreter.
+TEST_CASE("Options: a map literal is flattened in key order with the leading dash added")
+{
+    tk::Options options({{"width", 3}, {"text", "x"}});
+    const auto& words = options.words();
+    REQUIRE(words.size() == 4);
+    CHECK(words[0].as_string() == "-text");
+    CHECK(words[1].as_string() == "x");
+    CHECK(words[2].as_string() == "-width");
+    CHECK(words[3].as_int() == 3);
+
+    std::map<std::string, tk::ArgValue> legacy = {{"fill", "both"}};
+    tk::Options from_map = legacy;
+    REQUIRE(from_map.words().size() == 2);
+    CHECK(from_map.words()[0].as_string() == "-fill");
+}
+
+TEST_CASE("Options: the builder keeps call order and stores option names without allocating them")
+{
+    auto options = tk::opts().text("x").width(3).in_("parent").set("custom", true);
+    const auto& words = options.words();
+    REQUIRE(words.size() == 8);
+    CHECK(words[0].type() == tk::ArgValue::ValueType::STRING_REF);
+    CHECK(std::string(words[0].as_string_ref().data, words[0].as_string_ref().size) == "-text");
+    CHECK(std::string(words[4].as_string_ref().data, words[4].as_string_ref().size) == "-in");
+    CHECK(words[6].as_string() == "-custom");
+    CHECK(words[7].as_bool() == true);
+    CHECK(tk::opts().empty());
+}
+
+TEST_CASE("Options: widget APIs accept both the builder and map literals")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Label label(root, tk::opts().text("built").width(12));
+    CHECK(label.cget("text") == "built");
+    CHECK(label.cget("width") == "12");
+
+    label.config(tk::opts().text("changed").relief("sunken"));
+    CHECK(label.cget("text") == "changed");
+    CHECK(label.cget("relief") == "sunken");
+
+    label.config({{"text", "literal"}});
+    CHECK(label.cget("text") == "literal");
+
+    label.pack(tk::opts().side(tk::LEFT).padx(4));
+    CHECK(root.call({"dict", "get", root.call({"pack", "info", label.full_name()}), "-side"}) == "left");
+
+    tk::Canvas canvas(root);
+    auto id = canvas.create_rectangle(0, 0, 10, 10, tk::opts().fill("red").outline("blue"));
+    CHECK(canvas.itemcget(id, "fill") == "red");
+}
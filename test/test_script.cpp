@@ -0,0 +1,61 @@
+// Regression tests for tk::Script, a Tcl script kept as one persistent Tcl_Obj so that its
+// compiled bytecode is reused across run() calls (see docs/tasks.md section M).
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Script: a script without params runs at global level and can be run repeatedly")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    root.call({"set", "::script_counter", 0});
+    tk::Script increment("incr ::script_counter; set local_to_global 1");
+    for (int i = 0; i < 5; ++i)
+        increment.run();
+    CHECK(root.call_int({"set", "::script_counter"}) == 5);
+    // Without params the body is evaluated at global level, so plain variables are globals.
+    CHECK(root.call({"info", "exists", "::local_to_global"}) == "1");
+}
+
+TEST_CASE("Script: params are bound from run() arguments and stay local to the script")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Script add("set sum [expr {$a + $b}]; return $sum", {"a", "b"});
+    CHECK(add.run({2, 3}) == "5");
+    CHECK(add.run({10, -4}) == "6");
+    CHECK(root.call({"info", "exists", "::sum"}) == "0");
+
+    std::string payload(50000, 'x');
+    tk::Script length("string length $s", {"s"});
+    CHECK(length.run({tk::StringRef(payload)}) == "50000");
+}
+
+TEST_CASE("Script: failures follow the same success/error_policy rules as call()")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    tk::Script broken("error {script failed}");
+    bool ok = true;
+    CHECK(broken.run({}, &ok) == "script failed");
+    CHECK(ok == false);
+    CHECK_THROWS_AS(broken.run(), tk::Error);
+
+    tk::Script no_params("set x 1");
+    ok = true;
+    no_params.run({1}, &ok);
+    CHECK(ok == false);
+
+    tk::Script wrong_arity("set a", {"a"});
+    ok = true;
+    wrong_arity.run({1, 2}, &ok);
+    CHECK(ok == false);
+}
@@ -0,0 +1,147 @@
+// Regression tests for the Tcl-only interpreter mode (tk::create_tcl_only_interpreter(), see
+// docs/tasks.md section M). Each test runs on its own thread so it gets a fresh interpreter, and none
+// of them needs a display until a tk::Tk is explicitly constructed.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+
+namespace tk = cpp_tk;
+
+namespace
+{
+
+// Mean wall-clock time to create one interpreter on a fresh thread, in microseconds.
+template<typename Fn>
+double mean_startup_us(int rounds, Fn create)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i)
+        run_on_fresh_thread(create);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / rounds;
+}
+
+} // namespace
+
+TEST_CASE("Tcl-only interpreter: only the first call on a thread creates it")
+{
+    run_on_fresh_thread([]()
+    {
+        CHECK(tk::create_tcl_only_interpreter() == true);
+        CHECK(tk::create_tcl_only_interpreter() == false);
+    });
+
+    run_on_fresh_thread([]()
+    {
+        tk::create_tcl_only_interpreter();
+        tk::StringVar var;
+        CHECK(tk::interpreter_threads().size() >= 1);
+        CHECK(tk::create_tcl_only_interpreter() == false);
+    });
+}
+
+TEST_CASE("Tcl-only interpreter: call(), typed results and list splitting work without Tk")
+{
+    run_on_fresh_thread([]()
+    {
+        tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        tk::StringVar var;
+        var.set("hello");
+        CHECK(var.get() == "hello");
+
+        CHECK(var.call({"string", "toupper", "abc"}) == "ABC");
+        CHECK(var.call_int({"expr", "6 * 7"}) == 42);
+
+        auto items = var.call_list({"list", "a b", "c", ""});
+        REQUIRE(items.size() == 3);
+        CHECK(items[0] == "a b");
+        CHECK(items[2] == "");
+
+        std::vector<int> ints = {3, 1, 2};
+        CHECK(var.call({"lsort", "-integer", tk::IntArrayRef(ints)}) == "1 2 3");
+
+        tk::TclValue prebuilt(tk::list({1, 2, 3, 4}));
+        CHECK(var.call_int({"llength", prebuilt}) == 4);
+
+        // Tk commands simply do not exist in this interpreter.
+        CHECK_THROWS_AS(var.call({"winfo", "exists", "."}), tk::Error);
+    });
+}
+
+TEST_CASE("Tcl-only interpreter: TclValue can be built before any interpreter exists")
+{
+    run_on_fresh_thread([]()
+    {
+        tk::TclValue prebuilt(tk::list({1, 2, 3}));
+        CHECK(prebuilt.str() == "1 2 3");
+
+        // Building the value did not create (and Tk_Init) an interpreter for this thread.
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        CHECK(var.call_int({"llength", prebuilt}) == 3);
+    });
+}
+
+TEST_CASE("Tcl-only interpreter: tk::Script runs headless")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+
+        tk::Script add("expr {$a + $b}", {"a", "b"});
+        for (int i = 0; i < 10; ++i)
+            CHECK(add.run({i, 1}) == std::to_string(i + 1));
+
+        tk::Script body("set ::tcl_only_counter [expr {[info exists ::tcl_only_counter] ? $::tcl_only_counter + 1 : 1}]");
+        add.run({0, 0});
+        body.run();
+        CHECK(body.run() == "2");
+    });
+}
+
+TEST_CASE("Tcl-only interpreter: startup benchmark against the full Tcl+Tk startup")
+{
+    const int rounds = 20;
+    double tcl_only = mean_startup_us(rounds, []() { tk::create_tcl_only_interpreter(); });
+    MESSAGE("Tcl-only interpreter startup: " << tcl_only << " us (mean of " << rounds << ")");
+
+    // The full startup needs a display; report it only where Tk can actually be initialized.
+    bool tk_available = true;
+    double full = mean_startup_us(rounds, [&tk_available]()
+    {
+        try
+        {
+            tk::Tk root;
+            root.withdraw();
+        }
+        catch (const tk::Error&)
+        {
+            tk_available = false;
+        }
+    });
+    if (tk_available)
+        MESSAGE("Tcl+Tk interpreter startup: " << full << " us (mean of " << rounds << ")");
+    else
+        MESSAGE("Tcl+Tk interpreter startup: skipped (Tk_Init failed, no display)");
+    CHECK(tcl_only > 0.0);
+}
+
+TEST_CASE("Tcl-only interpreter: constructing tk::Tk loads Tk into the same interpreter")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        var.set("kept");
+
+        tk::Tk root;
+        root.withdraw();
+        CHECK(root.call({"set", var.name()}) == "kept");
+        CHECK(root.call_bool({"winfo", "exists", "."}) == true);
+    });
+}
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <atomic>
 #include <vector>
+#include <algorithm>
 
 namespace tk = cpp_tk;
 
@@ -69,3 +70,40 @@ TEST_CASE("post(): multiple worker threads can post safely")
 
     CHECK(jobs_done == worker_count);
 }
+
+TEST_CASE("Interpreter registry: dialogs on a thread without an interpreter neither create nor register one")
+{
+    std::string result = "unset";
+    std::thread::id dialog_thread;
+    std::thread worker([&]() {
+        dialog_thread = std::this_thread::get_id();
+        result = tk::messagebox::showinfo("title", "message");
+    });
+    worker.join();
+
+    CHECK(result.empty());
+    auto threads = tk::interpreter_threads();
+    CHECK(std::find(threads.begin(), threads.end(), dialog_thread) == threads.end());
+}
+
+TEST_CASE("Interpreter registry: each thread gets its own interpreter and is listed by interpreter_threads()")
+{
+    tk::set_error_policy(tk::ErrorPolicy::DEFAULT);
+    tk::Tk root;
+    root.withdraw();
+
+    std::thread::id worker_id;
+    std::string worker_value;
+    std::thread worker([&]() {
+        worker_id = std::this_thread::get_id();
+        tk::StringVar var;
+        var.set("worker");
+        worker_value = var.get();
+    });
+    worker.join();
+
+    CHECK(worker_value == "worker");
+    auto threads = tk::interpreter_threads();
+    CHECK(std::find(threads.begin(), threads.end(), std::this_thread::get_id()) != threads.end());
+    CHECK(std::find(threads.begin(), threads.end(), worker_id) != threads.end());
+}
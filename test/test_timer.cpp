@@ -0,0 +1,156 @@
+// Regression tests for tk::Timer (see docs/tasks.md section M): once()/every() run on Tcl timer handlers
+// without creating Tcl commands, periodic timers do not accumulate drift, and the handles cancel their
+// timer on destruction. The tests run headless on their own thread with a Tcl-only interpreter.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "cpp_tk.hpp"
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace tk = cpp_tk;
+
+TEST_CASE("Timer: once() fires a single time and creates no Tcl command")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        const auto commands = var.call_list({"info", "commands"}).size();
+
+        int fired = 0;
+        auto timer = tk::Timer::once(5, [&fired]() { ++fired; });
+        CHECK(timer.active());
+        CHECK(var.call_list({"info", "commands"}).size() == commands);
+
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return fired > 0; }));
+        CHECK(fired == 1);
+        CHECK_FALSE(timer.active());
+
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(fired == 1);
+    });
+}
+
+TEST_CASE("Timer: destroying or cancelling the handle cancels the timer and releases the callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        const auto live = tk::stats().live_callbacks;
+
+        int fired = 0;
+        auto token = std::make_shared<int>(0);
+        std::weak_ptr<int> watch = token;
+        {
+            auto timer = tk::Timer::once(1, [&fired, token]() { ++fired; });
+            token.reset();
+            CHECK(tk::stats().live_callbacks == live + 1);
+        }
+        CHECK(watch.expired());
+        CHECK(tk::stats().live_callbacks == live);
+
+        auto periodic = tk::Timer::every(1, [&fired]() { ++fired; });
+        periodic.cancel();
+        CHECK_FALSE(periodic.active());
+        CHECK_NOTHROW(periodic.cancel());
+
+        // Assigning another timer cancels the one held before.
+        auto replaced = tk::Timer::once(1, [&fired]() { ++fired; });
+        replaced = tk::Timer();
+        CHECK_FALSE(replaced.active());
+
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(fired == 0);
+        CHECK(tk::stats().live_callbacks == live);
+    });
+}
+
+TEST_CASE("Timer: detach() keeps the timer running without a handle")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        int fired = 0;
+        tk::Timer::once(1, [&fired]() { ++fired; }).detach();
+        CHECK(pump_until(var, std::chrono::milliseconds(2000), [&]() { return fired == 1; }));
+    });
+}
+
+TEST_CASE("Timer: every() keeps running until cancelled, also from inside its own callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+        const auto live = tk::stats().live_callbacks;
+
+        int ticks = 0;
+        tk::Timer timer;
+        timer = tk::Timer::every(1, [&]()
+        {
+            if (++ticks == 5)
+                timer.cancel();
+        });
+
+        REQUIRE(pump_until(var, std::chrono::milliseconds(2000), [&]() { return !timer.active(); }));
+        CHECK(ticks == 5);
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(ticks == 5);
+        CHECK(tk::stats().live_callbacks == live);
+    });
+}
+
+TEST_CASE("Timer: every() does not accumulate the time spent in its callback")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        // Each tick spends most of the period in the callback. Re-arming after the callback (as
+        // after() chains do) can never finish 20 periods in less than 20 * (20 + 15) ms, since both the
+        // wait and the sleep are lower bounds. Drift-free ticks take about 20 * 20 ms, which leaves
+        // roughly 300 ms of slack for slow (sanitizer) builds and loaded machines.
+        const int period_ms = 20;
+        const int busy_ms = 15;
+        const int rounds = 20;
+        int ticks = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto timer = tk::Timer::every(period_ms, [&ticks, busy_ms]()
+        {
+            ++ticks;
+            std::this_thread::sleep_for(std::chrono::milliseconds(busy_ms));
+        });
+        REQUIRE(pump_until(var, std::chrono::milliseconds(10000), [&]() { return ticks >= rounds; }));
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        MESSAGE("every(" << period_ms << "): " << rounds << " ticks in " << elapsed.count() << " ms");
+        CHECK(elapsed.count() < rounds * (period_ms + busy_ms));
+    });
+}
+
+TEST_CASE("Timer: reset_interpreter() cancels pending timers")
+{
+    run_on_fresh_thread([]()
+    {
+        REQUIRE(tk::create_tcl_only_interpreter());
+        tk::StringVar var;
+
+        int fired = 0;
+        auto timer = tk::Timer::every(1, [&fired]() { ++fired; });
+        tk::reset_interpreter();
+        CHECK_FALSE(timer.active());
+
+        var.call({"after", 20});
+        var.call({"update"});
+        CHECK(fired == 0);
+    });
+}